@@ -0,0 +1,71 @@
+Attribute VB_Name = "modOrders"
+Option Explicit
+
+' Order processing module used as the seed corpus for the
+' benchmark suite; larger corpora repeat these procedures.
+
+Private Const MAX_ORDERS As Integer = 500
+Private Const TAX_RATE As Double = 0.0825
+
+Private Type OrderLine
+    ProductId As Long
+    Quantity As Integer
+    UnitPrice As Currency
+End Type
+
+Private m_orderCount As Integer
+Private m_lines(1 To MAX_ORDERS) As OrderLine
+
+Public Function AddOrderLine(ByVal productId As Long, ByVal quantity As Integer, ByVal unitPrice As Currency) As Boolean
+    If m_orderCount >= MAX_ORDERS Then
+        AddOrderLine = False
+        Exit Function
+    End If
+
+    m_orderCount = m_orderCount + 1
+    With m_lines(m_orderCount)
+        .ProductId = productId
+        .Quantity = quantity
+        .UnitPrice = unitPrice
+    End With
+    AddOrderLine = True
+End Function
+
+Public Function OrderTotal() As Currency
+    Dim i As Integer
+    Dim subtotal As Currency
+
+    For i = 1 To m_orderCount
+        subtotal = subtotal + m_lines(i).Quantity * m_lines(i).UnitPrice
+    Next i
+
+    OrderTotal = subtotal * (1 + TAX_RATE)
+End Function
+
+Public Sub ClearOrders()
+    Dim i As Integer
+    For i = 1 To m_orderCount
+        m_lines(i).ProductId = 0
+        m_lines(i).Quantity = 0
+        m_lines(i).UnitPrice = 0
+    Next i
+    m_orderCount = 0
+End Sub
+
+Private Function FormatLine(ByVal index As Integer) As String
+    If index < 1 Or index > m_orderCount Then
+        FormatLine = ""
+        Exit Function
+    End If
+
+    FormatLine = CStr(m_lines(index).ProductId) & vbTab & _
+        CStr(m_lines(index).Quantity) & vbTab & _
+        Format(m_lines(index).UnitPrice, "Currency")
+End Function
+
+Public Sub DumpOrders()
+    Dim i As Integer
+    For i = 1 To m_orderCount
+        Debug.Print FormatLine(i)
+    Next i
+End Sub
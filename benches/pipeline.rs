@@ -0,0 +1,183 @@
+//! Benchmarks for the parse → convert → index pipeline.
+//!
+//! Corpora: the checked-in seed module (`corpus/small.bas`) plus
+//! deterministic medium/large variants built by repeating its
+//! procedures under unique names, so symbol counts scale with size.
+//! Every group reports both bytes/s (as criterion throughput) and a
+//! lines/s figure via the element-throughput twin group.
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use tower_lsp::lsp_types::Url;
+use vb6_lsp::analysis::{build_symbol_table, SourcePosition};
+use vb6_lsp::parser::{convert_tree, TreeSitterVb6Parser, Vb6Parser};
+
+const SMALL: &str = include_str!("corpus/small.bas");
+
+/// Build a larger module by repeating the seed procedures with
+/// uniquely suffixed names (same shape, more symbols).
+fn corpus(copies: usize) -> String {
+    let mut out = String::with_capacity(SMALL.len() * (copies + 1));
+    out.push_str(SMALL);
+    for i in 0..copies {
+        let body = SMALL
+            .lines()
+            // Attributes/Option/Type/module-level vars only once
+            .skip_while(|l| !l.starts_with("Public Function AddOrderLine"))
+            .collect::<Vec<_>>()
+            .join("\n");
+        out.push('\n');
+        out.push_str(
+            &body
+                .replace("AddOrderLine", &format!("AddOrderLine{}", i))
+                .replace("OrderTotal", &format!("OrderTotal{}", i))
+                .replace("ClearOrders", &format!("ClearOrders{}", i))
+                .replace("FormatLine", &format!("FormatLine{}", i))
+                .replace("DumpOrders", &format!("DumpOrders{}", i)),
+        );
+        out.push('\n');
+    }
+    out
+}
+
+fn corpora() -> Vec<(&'static str, String)> {
+    vec![
+        ("small", SMALL.to_string()),
+        ("medium", corpus(50)),
+        ("large", corpus(500)),
+    ]
+}
+
+fn bench_parse_cold(c: &mut Criterion) {
+    let mut parser = TreeSitterVb6Parser::new().unwrap();
+
+    let mut group = c.benchmark_group("parse_cold_bytes");
+    for (name, source) in corpora() {
+        group.throughput(Throughput::Bytes(source.len() as u64));
+        group.bench_with_input(BenchmarkId::from_parameter(name), &source, |b, src| {
+            b.iter(|| parser.parse(src, None).unwrap())
+        });
+    }
+    group.finish();
+
+    let mut group = c.benchmark_group("parse_cold_lines");
+    for (name, source) in corpora() {
+        group.throughput(Throughput::Elements(source.lines().count() as u64));
+        group.bench_with_input(BenchmarkId::from_parameter(name), &source, |b, src| {
+            b.iter(|| parser.parse(src, None).unwrap())
+        });
+    }
+    group.finish();
+}
+
+fn bench_parse_incremental(c: &mut Criterion) {
+    let mut parser = TreeSitterVb6Parser::new().unwrap();
+
+    let mut group = c.benchmark_group("parse_incremental_bytes");
+    for (name, source) in corpora() {
+        // Append one character inside the last procedure body, the way
+        // a keystroke arrives from the editor
+        let insert_at = source.rfind("Debug.Print").unwrap();
+        let mut edited = source.clone();
+        edited.insert(insert_at, ' ');
+
+        let base = parser.parse(&source, None).unwrap();
+        let mut old_tree = base.clone();
+        let point = {
+            let prefix = &source[..insert_at];
+            let row = prefix.lines().count().saturating_sub(1);
+            let col = prefix.lines().last().map_or(0, str::len);
+            tree_sitter::Point::new(row, col)
+        };
+        let edit = tree_sitter::InputEdit {
+            start_byte: insert_at,
+            old_end_byte: insert_at,
+            new_end_byte: insert_at + 1,
+            start_position: point,
+            old_end_position: point,
+            new_end_position: tree_sitter::Point::new(point.row, point.column + 1),
+        };
+
+        group.throughput(Throughput::Bytes(edited.len() as u64));
+        group.bench_with_input(BenchmarkId::from_parameter(name), &edited, |b, src| {
+            b.iter(|| {
+                old_tree = base.clone();
+                old_tree.edit(&edit);
+                parser.parse(src, Some(&old_tree)).unwrap()
+            })
+        });
+    }
+    group.finish();
+}
+
+fn bench_convert(c: &mut Criterion) {
+    let mut parser = TreeSitterVb6Parser::new().unwrap();
+
+    let mut group = c.benchmark_group("convert_bytes");
+    for (name, source) in corpora() {
+        let tree = parser.parse(&source, None).unwrap();
+        group.throughput(Throughput::Bytes(source.len() as u64));
+        group.bench_with_input(BenchmarkId::from_parameter(name), &source, |b, src| {
+            b.iter(|| convert_tree(&tree, src))
+        });
+    }
+    group.finish();
+}
+
+fn bench_build_symbol_table(c: &mut Criterion) {
+    let mut parser = TreeSitterVb6Parser::new().unwrap();
+    let uri = Url::parse("file:///bench.bas").unwrap();
+
+    let mut group = c.benchmark_group("build_symbol_table_lines");
+    for (name, source) in corpora() {
+        let tree = parser.parse(&source, None).unwrap();
+        group.throughput(Throughput::Elements(source.lines().count() as u64));
+        group.bench_with_input(BenchmarkId::from_parameter(name), &source, |b, src| {
+            b.iter(|| build_symbol_table(uri.clone(), src, &tree))
+        });
+    }
+    group.finish();
+}
+
+fn bench_parse_legacy(c: &mut Criterion) {
+    let parser = Vb6Parser::new();
+
+    // The line-based fallback parser for files the grammar rejects;
+    // dominated by per-line keyword dispatch
+    let mut group = c.benchmark_group("parse_legacy_lines");
+    for (name, source) in corpora() {
+        group.throughput(Throughput::Elements(source.lines().count() as u64));
+        group.bench_with_input(BenchmarkId::from_parameter(name), &source, |b, src| {
+            b.iter(|| parser.parse_legacy(src).unwrap())
+        });
+    }
+    group.finish();
+}
+
+fn bench_lookup_at_position(c: &mut Criterion) {
+    let mut parser = TreeSitterVb6Parser::new().unwrap();
+    let uri = Url::parse("file:///bench.bas").unwrap();
+
+    let mut group = c.benchmark_group("lookup_at_position");
+    for (name, source) in corpora() {
+        let tree = parser.parse(&source, None).unwrap();
+        let table = build_symbol_table(uri.clone(), &source, &tree);
+
+        // Look up a module-level symbol from deep inside the file
+        let pos = SourcePosition::new(source.lines().count() as u32 - 2, 8);
+        group.bench_with_input(BenchmarkId::from_parameter(name), &table, |b, table| {
+            b.iter(|| table.lookup_at_position("m_orderCount", pos))
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_parse_cold,
+    bench_parse_incremental,
+    bench_convert,
+    bench_build_symbol_table,
+    bench_parse_legacy,
+    bench_lookup_at_position
+);
+criterion_main!(benches);
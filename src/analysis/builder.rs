@@ -5,6 +5,7 @@
 use tree_sitter::{Node, Tree};
 use tower_lsp::lsp_types::Url;
 
+use super::interner::Name;
 use super::position::{SourcePosition, SourceRange};
 use super::scope::{ScopeId, ScopeKind};
 use super::symbol::{ParameterInfo, SymbolId, SymbolKind, TypeInfo, Visibility};
@@ -40,6 +41,7 @@ impl<'a> SymbolTableBuilder<'a> {
         self.scope_stack = vec![self.table.module_scope];
         self.collect_references(&tree.root_node());
 
+        self.table.finalize_references();
         self.table
     }
 
@@ -120,12 +122,12 @@ impl<'a> SymbolTableBuilder<'a> {
     /// Extract type from as_clause node
     fn extract_type_from_as_clause(&self, node: &Node) -> Option<TypeInfo> {
         if let Some(type_node) = self.find_field(node, "type") {
-            let name = self.node_text(&type_node).to_string();
-            let is_array = name.ends_with("()") || self.find_children_by_kind(node, "array_bounds").len() > 0;
+            let text = self.node_text(&type_node);
+            let is_array = text.ends_with("()") || self.find_children_by_kind(node, "array_bounds").len() > 0;
             let is_new = self.has_child_keyword(node, "new");
 
             Some(TypeInfo {
-                name: name.trim_end_matches("()").to_string(),
+                name: Name::new(text.trim_end_matches("()")),
                 is_array,
                 is_new,
             })
@@ -211,7 +213,7 @@ impl<'a> SymbolTableBuilder<'a> {
         for vl in self.find_children_by_kind(node, "variable_list") {
             for vd in self.find_children_by_kind(&vl, "variable_declarator") {
                 if let Some(name_node) = self.find_field(&vd, "name") {
-                    let name = self.node_text(&name_node).to_string();
+                    let name = Name::new(self.node_text(&name_node));
                     let definition_range = self.node_range(&vd);
                     let name_range = self.node_range(&name_node);
 
@@ -246,7 +248,7 @@ impl<'a> SymbolTableBuilder<'a> {
 
         for cd in self.find_children_by_kind(node, "constant_declarator") {
             if let Some(name_node) = self.find_field(&cd, "name") {
-                let name = self.node_text(&name_node).to_string();
+                let name = Name::new(self.node_text(&name_node));
                 let definition_range = self.node_range(&cd);
                 let name_range = self.node_range(&name_node);
 
@@ -284,7 +286,7 @@ impl<'a> SymbolTableBuilder<'a> {
         let visibility = self.extract_visibility(node);
 
         if let Some(name_node) = self.find_field(node, "name") {
-            let name = self.node_text(&name_node).to_string();
+            let name = Name::new(self.node_text(&name_node));
             let definition_range = self.node_range(node);
             let name_range = self.node_range(&name_node);
 
@@ -300,7 +302,7 @@ impl<'a> SymbolTableBuilder<'a> {
             // Process type members
             for tm in self.find_children_by_kind(node, "type_member") {
                 if let Some(member_name_node) = self.find_field(&tm, "name") {
-                    let member_name = self.node_text(&member_name_node).to_string();
+                    let member_name = Name::new(self.node_text(&member_name_node));
                     let member_def_range = self.node_range(&tm);
                     let member_name_range = self.node_range(&member_name_node);
 
@@ -328,7 +330,7 @@ impl<'a> SymbolTableBuilder<'a> {
         let visibility = self.extract_visibility(node);
 
         if let Some(name_node) = self.find_field(node, "name") {
-            let name = self.node_text(&name_node).to_string();
+            let name = Name::new(self.node_text(&name_node));
             let definition_range = self.node_range(node);
             let name_range = self.node_range(&name_node);
 
@@ -344,7 +346,7 @@ impl<'a> SymbolTableBuilder<'a> {
             // Process enum members
             for em in self.find_children_by_kind(node, "enum_member") {
                 if let Some(member_name_node) = self.find_field(&em, "name") {
-                    let member_name = self.node_text(&member_name_node).to_string();
+                    let member_name = Name::new(self.node_text(&member_name_node));
                     let member_def_range = self.node_range(&em);
                     let member_name_range = self.node_range(&member_name_node);
 
@@ -401,7 +403,7 @@ impl<'a> SymbolTableBuilder<'a> {
         let visibility = self.extract_visibility(node);
 
         if let Some(name_node) = self.find_field(node, "name") {
-            let name = self.node_text(&name_node).to_string();
+            let name = Name::new(self.node_text(&name_node));
             let definition_range = self.node_range(node);
             let name_range = self.node_range(&name_node);
 
@@ -447,7 +449,7 @@ impl<'a> SymbolTableBuilder<'a> {
         for pl in self.find_children_by_kind(node, "parameter_list") {
             for param in self.find_children_by_kind(&pl, "parameter") {
                 if let Some(name_node) = self.find_field(&param, "name") {
-                    let name = self.node_text(&name_node).to_string();
+                    let name = Name::new(self.node_text(&name_node));
                     let param_text = self.node_text(&param).to_uppercase();
 
                     let by_ref = !param_text.contains("BYVAL");
@@ -496,7 +498,7 @@ impl<'a> SymbolTableBuilder<'a> {
         let visibility = self.extract_visibility(node);
 
         if let Some(name_node) = self.find_field(node, "name") {
-            let name = self.node_text(&name_node).to_string();
+            let name = Name::new(self.node_text(&name_node));
             let definition_range = self.node_range(node);
             let name_range = self.node_range(&name_node);
 
@@ -536,7 +538,7 @@ impl<'a> SymbolTableBuilder<'a> {
         for pl in self.find_children_by_kind(node, "parameter_list") {
             for param in self.find_children_by_kind(&pl, "parameter") {
                 if let Some(name_node) = self.find_field(&param, "name") {
-                    let name = self.node_text(&name_node).to_string();
+                    let name = Name::new(self.node_text(&name_node));
                     let param_text = self.node_text(&param).to_uppercase();
 
                     let by_ref = !param_text.contains("BYVAL");
@@ -568,7 +570,7 @@ impl<'a> SymbolTableBuilder<'a> {
         let visibility = self.extract_visibility(node);
 
         if let Some(name_node) = self.find_field(node, "name") {
-            let name = self.node_text(&name_node).to_string();
+            let name = Name::new(self.node_text(&name_node));
             let definition_range = self.node_range(node);
             let name_range = self.node_range(&name_node);
 
@@ -615,7 +617,7 @@ impl<'a> SymbolTableBuilder<'a> {
 
         // Register loop variable
         if let Some(counter_node) = self.find_field(node, "counter") {
-            let name = self.node_text(&counter_node).to_string();
+            let name = Name::new(self.node_text(&counter_node));
             let name_range = self.node_range(&counter_node);
 
             self.table.create_symbol(
@@ -642,7 +644,7 @@ impl<'a> SymbolTableBuilder<'a> {
 
         // Register element variable
         if let Some(element_node) = self.find_field(node, "element") {
-            let name = self.node_text(&element_node).to_string();
+            let name = Name::new(self.node_text(&element_node));
             let name_range = self.node_range(&element_node);
 
             self.table.create_symbol(
@@ -664,7 +666,7 @@ impl<'a> SymbolTableBuilder<'a> {
     fn visit_label(&mut self, node: &Node) {
         // Labels are the first child (identifier or integer)
         if let Some(label_node) = node.child(0) {
-            let name = self.node_text(&label_node).to_string();
+            let name = Name::new(self.node_text(&label_node));
             let range = self.node_range(node);
             let name_range = self.node_range(&label_node);
 
@@ -689,7 +691,7 @@ impl<'a> SymbolTableBuilder<'a> {
         tracing::debug!("visit_form_block: node kind={}", node.kind());
 
         if let Some(name_node) = self.find_field(node, "name") {
-            let name = self.node_text(&name_node).to_string();
+            let name = Name::new(self.node_text(&name_node));
             let definition_range = self.node_range(node);
             let name_range = self.node_range(&name_node);
 
@@ -697,11 +699,11 @@ impl<'a> SymbolTableBuilder<'a> {
 
             // Get the control type (e.g., "VB.TextBox" -> "TextBox")
             let type_info = self.find_field(node, "type").map(|type_node| {
-                let full_type = self.node_text(&type_node).to_string();
+                let full_type = self.node_text(&type_node);
                 // Extract just the control type (after the dot)
-                let type_name = full_type.split('.').last().unwrap_or(&full_type).to_string();
+                let type_name = full_type.split('.').last().unwrap_or(full_type);
                 TypeInfo {
-                    name: type_name,
+                    name: Name::new(type_name),
                     is_array: false,
                     is_new: false,
                 }
@@ -866,9 +868,8 @@ impl<'a> SymbolTableBuilder<'a> {
     /// Find the scope for a procedure by looking up the symbol and then finding its scope
     fn find_procedure_scope(&self, name: &str) -> Option<ScopeId> {
         // Find the symbol for this procedure
-        let name_lower = name.to_lowercase();
         for symbol in self.table.all_symbols() {
-            if symbol.name.to_lowercase() == name_lower && symbol.kind.creates_scope() {
+            if symbol.name.as_str().eq_ignore_ascii_case(name) && symbol.kind.creates_scope() {
                 // Find the scope that has this symbol as its defining symbol
                 for scope in self.table.all_scopes() {
                     if scope.defining_symbol == Some(symbol.id) {
@@ -897,7 +898,7 @@ impl<'a> SymbolTableBuilder<'a> {
             return;
         }
 
-        let name = self.node_text(node).to_string();
+        let name = Name::new(self.node_text(node));
         let range = self.node_range(node);
         let scope_id = self.current_scope();
 
@@ -908,6 +909,11 @@ impl<'a> SymbolTableBuilder<'a> {
         if let Some(symbol) = self.table.lookup_symbol(&name, scope_id) {
             let symbol_id = symbol.id;
             self.table.add_reference(symbol_id, range, scope_id, is_assignment);
+        } else {
+            // No local declaration; keep the use site so cross-file
+            // find-all-references can match it against public symbols
+            // declared in other modules
+            self.table.add_unresolved_reference(name, range);
         }
     }
 
@@ -976,6 +982,155 @@ pub fn build_symbol_table(uri: Url, source: &str, tree: &Tree) -> SymbolTable {
     builder.build(tree)
 }
 
+/// Incrementally update a symbol table after edits.
+///
+/// Positions are shifted by the recorded edits, then only the procedures
+/// whose bodies intersect `Tree::changed_ranges` are re-visited; everything
+/// else is kept in place. Falls back to a full rebuild whenever a change
+/// cannot be attributed to an existing procedure body (module-level edits,
+/// added or removed procedures, structural surprises).
+pub fn update_symbol_table(
+    uri: Url,
+    source: &str,
+    new_tree: &Tree,
+    edited_old_tree: &Tree,
+    edits: &[tree_sitter::InputEdit],
+    mut table: SymbolTable,
+) -> SymbolTable {
+    // Shift stored positions into the new document's coordinates
+    for edit in edits {
+        table.shift_for_edit(edit);
+    }
+
+    // Figure out what actually changed (ranges are in new-tree coordinates).
+    // A pure insertion or deletion may not produce a changed range, so the
+    // edit regions themselves are included as well.
+    let mut changed: Vec<SourceRange> = edited_old_tree
+        .changed_ranges(new_tree)
+        .map(|r| {
+            SourceRange::new(
+                SourcePosition::from_ts_point(r.start_point),
+                SourcePosition::from_ts_point(r.end_point),
+            )
+        })
+        .collect();
+    for edit in edits {
+        changed.push(SourceRange::new(
+            SourcePosition::from_ts_point(edit.start_position),
+            SourcePosition::from_ts_point(edit.new_end_position),
+        ));
+    }
+
+    // Map each changed range onto the innermost procedure scope that fully
+    // encloses it; bail out if a change escapes every procedure body.
+    let mut dirty_procs: Vec<(SymbolId, ScopeId)> = Vec::new();
+    for range in &changed {
+        let mut enclosing: Option<(SymbolId, ScopeId, u64)> = None;
+        for scope in table.all_scopes() {
+            if scope.kind == ScopeKind::Procedure
+                && scope.range.contains(range.start)
+                && scope.range.contains(range.end)
+            {
+                let size = scope.range.size();
+                if enclosing.map_or(true, |(_, _, best)| size < best) {
+                    if let Some(symbol_id) = scope.defining_symbol {
+                        enclosing = Some((symbol_id, scope.id, size));
+                    }
+                }
+            }
+        }
+        match enclosing {
+            Some((symbol_id, scope_id, _)) => {
+                if !dirty_procs.iter().any(|(_, s)| *s == scope_id) {
+                    dirty_procs.push((symbol_id, scope_id));
+                }
+            }
+            None => return build_symbol_table(uri, source, new_tree),
+        }
+    }
+
+    let module_scope = table.module_scope;
+    let mut builder = SymbolTableBuilder {
+        source,
+        table,
+        scope_stack: vec![module_scope],
+    };
+
+    for (symbol_id, scope_id) in dirty_procs {
+        let (name, scope_range) = match (
+            builder.table.get_symbol(symbol_id),
+            builder.table.get_scope(scope_id),
+        ) {
+            (Some(symbol), Some(scope)) => (symbol.name.clone(), scope.range),
+            _ => return build_symbol_table(uri, source, new_tree),
+        };
+
+        // Find the procedure's node in the new tree via its shifted range
+        let start = tree_sitter::Point {
+            row: scope_range.start.line as usize,
+            column: scope_range.start.column as usize,
+        };
+        let end = tree_sitter::Point {
+            row: scope_range.end.line as usize,
+            column: scope_range.end.column as usize,
+        };
+        let mut node = match new_tree.root_node().descendant_for_point_range(start, end) {
+            Some(n) => n,
+            None => return build_symbol_table(uri, source, new_tree),
+        };
+        while !matches!(
+            node.kind(),
+            "sub_declaration" | "function_declaration" | "property_declaration"
+        ) {
+            match node.parent() {
+                Some(parent) => node = parent,
+                None => return build_symbol_table(uri, source, new_tree),
+            }
+        }
+
+        // The node we found must still be the same procedure
+        let node_name = node
+            .child_by_field_name("name")
+            .map(|n| n.utf8_text(source.as_bytes()).unwrap_or(""))
+            .unwrap_or("");
+        if !node_name.eq_ignore_ascii_case(&name) {
+            return build_symbol_table(uri, source, new_tree);
+        }
+
+        // Preserve references to this procedure from elsewhere in the file,
+        // then tear the old procedure down and rebuild it from the new node
+        let outside_refs = builder.table.take_references_to(symbol_id);
+        builder.table.remove_references_in_range(scope_range);
+        builder
+            .table
+            .remove_references_in_range(SourceRange::from_ts_node(&node));
+        builder.table.remove_scope_subtree(scope_id);
+        builder.table.remove_symbol(symbol_id);
+
+        builder.scope_stack = vec![module_scope];
+        builder.visit_node(&node);
+        builder.scope_stack = vec![module_scope];
+        builder.collect_references(&node);
+
+        // Re-point surviving outside references at the rebuilt symbol
+        if let Some(new_symbol) = builder.table.lookup_symbol(&name, module_scope) {
+            let new_id = new_symbol.id;
+            for mut reference in outside_refs {
+                if !scope_range.contains(reference.range.start) {
+                    reference.symbol_id = new_id;
+                    builder.table.push_reference(reference);
+                }
+            }
+        }
+    }
+
+    let mut table = builder.table;
+    table.prune_dead_references();
+    table.rebuild_spatial_indexes();
+    table.finalize_references();
+    table
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
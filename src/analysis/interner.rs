@@ -0,0 +1,210 @@
+//! String Interner
+//!
+//! Interns identifiers and type names so each distinct spelling is
+//! allocated once per process instead of once per symbol. Every interned
+//! name also carries the id of its case-folded equivalence class, which
+//! is what scope maps and lookups compare — VB6 names are
+//! case-insensitive, so "MyVar" and "MYVAR" share one `NameId`.
+
+use std::collections::HashMap;
+use std::fmt;
+use std::ops::Deref;
+use std::sync::{Arc, RwLock};
+
+use once_cell::sync::Lazy;
+
+/// Identifier of a case-folded name equivalence class
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct NameId(pub u32);
+
+/// An interned identifier or type name.
+///
+/// Cloning bumps a refcount. Equality and hashing compare the folded
+/// class id, matching VB6's case-insensitive name semantics; use
+/// `as_str` when exact spelling matters.
+#[derive(Clone)]
+pub struct Name {
+    text: Arc<str>,
+    id: NameId,
+}
+
+impl Name {
+    /// Intern a string (same as [`intern`])
+    pub fn new(text: &str) -> Self {
+        intern(text)
+    }
+
+    /// The case-folded class id
+    pub fn id(&self) -> NameId {
+        self.id
+    }
+
+    /// The original-case text
+    pub fn as_str(&self) -> &str {
+        &self.text
+    }
+
+    /// The shared text allocation
+    pub fn as_arc(&self) -> &Arc<str> {
+        &self.text
+    }
+}
+
+impl Deref for Name {
+    type Target = str;
+
+    fn deref(&self) -> &str {
+        &self.text
+    }
+}
+
+impl fmt::Display for Name {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.write_str(&self.text)
+    }
+}
+
+impl fmt::Debug for Name {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        fmt::Debug::fmt(&*self.text, f)
+    }
+}
+
+impl PartialEq for Name {
+    fn eq(&self, other: &Self) -> bool {
+        self.id == other.id
+    }
+}
+
+impl Eq for Name {}
+
+impl std::hash::Hash for Name {
+    fn hash<H: std::hash::Hasher>(&self, state: &mut H) {
+        self.id.hash(state);
+    }
+}
+
+// Exact-spelling comparisons against plain strings (used by tests and
+// display code)
+impl PartialEq<str> for Name {
+    fn eq(&self, other: &str) -> bool {
+        &*self.text == other
+    }
+}
+
+impl PartialEq<&str> for Name {
+    fn eq(&self, other: &&str) -> bool {
+        &*self.text == *other
+    }
+}
+
+// Names serialize as their exact text and are re-interned on load:
+// `NameId`s are assigned per process, so persisting them (e.g. in the
+// on-disk symbol cache) would be meaningless in the next run.
+impl serde::Serialize for Name {
+    fn serialize<S: serde::Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        serializer.serialize_str(&self.text)
+    }
+}
+
+impl<'de> serde::Deserialize<'de> for Name {
+    fn deserialize<D: serde::Deserializer<'de>>(deserializer: D) -> Result<Self, D::Error> {
+        let text = String::deserialize(deserializer)?;
+        Ok(intern(&text))
+    }
+}
+
+impl From<&str> for Name {
+    fn from(text: &str) -> Self {
+        intern(text)
+    }
+}
+
+impl From<String> for Name {
+    fn from(text: String) -> Self {
+        intern(&text)
+    }
+}
+
+/// The interner's shared state
+#[derive(Default)]
+struct Interner {
+    /// Exact spelling -> interned name
+    exact: HashMap<Arc<str>, Name>,
+    /// Case-folded spelling -> class id
+    folded: HashMap<String, NameId>,
+}
+
+static INTERNER: Lazy<RwLock<Interner>> = Lazy::new(|| RwLock::new(Interner::default()));
+
+/// Intern a string, returning a shared `Name`
+pub fn intern(text: &str) -> Name {
+    // Fast path: the exact spelling has been seen before
+    if let Some(name) = INTERNER.read().unwrap().exact.get(text) {
+        return name.clone();
+    }
+
+    let mut interner = INTERNER.write().unwrap();
+    // Re-check under the write lock (another thread may have raced us)
+    if let Some(name) = interner.exact.get(text) {
+        return name.clone();
+    }
+
+    let folded = text.to_lowercase();
+    let next_id = NameId(interner.folded.len() as u32);
+    let id = *interner.folded.entry(folded).or_insert(next_id);
+
+    let arc: Arc<str> = Arc::from(text);
+    let name = Name {
+        text: Arc::clone(&arc),
+        id,
+    };
+    interner.exact.insert(arc, name.clone());
+    name
+}
+
+/// Look up the folded class id for a string without interning it.
+/// Returns `None` if no name with this folded spelling was ever interned
+/// (in which case no symbol with this name can exist either).
+pub fn folded_id(text: &str) -> Option<NameId> {
+    INTERNER
+        .read()
+        .unwrap()
+        .folded
+        .get(&text.to_lowercase())
+        .copied()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_interning_shares_allocations() {
+        let a = intern("MyVariable");
+        let b = intern("MyVariable");
+        assert!(Arc::ptr_eq(a.as_arc(), b.as_arc()));
+        assert_eq!(a.id(), b.id());
+    }
+
+    #[test]
+    fn test_case_folded_class_ids() {
+        let a = intern("Counter");
+        let b = intern("COUNTER");
+
+        // Different spellings keep their own text...
+        assert_eq!(a.as_str(), "Counter");
+        assert_eq!(b.as_str(), "COUNTER");
+
+        // ...but share a folded class id, so they compare equal
+        assert_eq!(a.id(), b.id());
+        assert_eq!(a, b);
+    }
+
+    #[test]
+    fn test_folded_id_lookup() {
+        let name = intern("gActiveForm");
+        assert_eq!(folded_id("GACTIVEFORM"), Some(name.id()));
+        assert_eq!(folded_id("never_interned_name_xyzzy"), None);
+    }
+}
@@ -0,0 +1,159 @@
+//! Completion matching and ranking
+//!
+//! Scores candidate labels against the prefix the user has typed so the
+//! server can return a small ranked list instead of everything in scope.
+//! The scorer is camelCase/underscore aware: query characters that land
+//! on word boundaries ("GFN" against "GetFileName", "u_b" against
+//! "update_buffer") outrank the same characters scattered mid-word.
+
+use tower_lsp::lsp_types::CompletionItem;
+
+/// Hard cap on the number of items returned for one completion request.
+/// When the candidate pool is larger the response is marked incomplete
+/// so the client re-queries as the user types more.
+pub const MAX_COMPLETION_RESULTS: usize = 100;
+
+/// Score `candidate` against `query`, or `None` if it does not match.
+///
+/// Matching is a case-insensitive subsequence test; scoring rewards
+/// matches at the start of the label, after an underscore, at a
+/// lowercase-to-uppercase transition, and runs of consecutive matches.
+/// Shorter labels win ties. An empty query matches everything equally.
+pub fn match_score(query: &str, candidate: &str) -> Option<i64> {
+    if query.is_empty() {
+        return Some(0);
+    }
+
+    let cand: Vec<char> = candidate.chars().collect();
+    let mut score: i64 = 0;
+    let mut ci = 0usize;
+    let mut prev_matched = false;
+
+    for qc in query.chars() {
+        let ql = qc.to_lowercase().next().unwrap_or(qc);
+
+        // Greedy scan forward for the next occurrence
+        let cc = loop {
+            let cc = *cand.get(ci)?;
+            if cc.to_lowercase().next().unwrap_or(cc) == ql {
+                break cc;
+            }
+            ci += 1;
+            prev_matched = false;
+        };
+
+        let mut s: i64 = 1;
+        if prev_matched {
+            s += 8;
+        }
+        if ci == 0 {
+            s += 16;
+        } else {
+            let prev = cand[ci - 1];
+            if prev == '_' {
+                s += 12;
+            } else if prev.is_lowercase() && cc.is_uppercase() {
+                s += 12;
+            }
+        }
+        if cc == qc {
+            s += 2;
+        }
+
+        score += s;
+        ci += 1;
+        prev_matched = true;
+    }
+
+    // Prefer shorter candidates when the matched characters score equally
+    Some(score - cand.len() as i64 / 4)
+}
+
+/// Rank a candidate pool against the typed prefix and cap the result.
+///
+/// Returns the top items plus an `is_incomplete` flag for the LSP
+/// response: `true` means more matches were cut off and the client
+/// should re-request as the prefix grows.
+pub fn rank_completions(query: &str, pool: &[CompletionItem]) -> (Vec<CompletionItem>, bool) {
+    let mut scored: Vec<(i64, &CompletionItem)> = pool
+        .iter()
+        .filter_map(|item| {
+            let key = item.filter_text.as_deref().unwrap_or(&item.label);
+            match_score(query, key).map(|s| (s, item))
+        })
+        .collect();
+
+    scored.sort_by(|a, b| b.0.cmp(&a.0).then_with(|| a.1.label.cmp(&b.1.label)));
+
+    let truncated = scored.len() > MAX_COMPLETION_RESULTS;
+    let items = scored
+        .into_iter()
+        .take(MAX_COMPLETION_RESULTS)
+        .map(|(_, item)| item.clone())
+        .collect();
+
+    (items, truncated)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn item(label: &str) -> CompletionItem {
+        CompletionItem {
+            label: label.to_string(),
+            ..Default::default()
+        }
+    }
+
+    #[test]
+    fn test_prefix_outranks_scattered() {
+        let prefix = match_score("get", "GetFileName").unwrap();
+        let scattered = match_score("get", "LargestElement").unwrap();
+        assert!(prefix > scattered);
+    }
+
+    #[test]
+    fn test_camel_case_initials() {
+        // Word-boundary hits should beat a plain prefix on an unrelated word
+        let initials = match_score("gfn", "GetFileName").unwrap();
+        let plain = match_score("gfn", "gfnord").unwrap();
+        assert!(initials > plain);
+    }
+
+    #[test]
+    fn test_underscore_boundaries() {
+        let boundary = match_score("ub", "update_buffer").unwrap();
+        let midword = match_score("ub", "scrubbed").unwrap();
+        assert!(boundary > midword);
+    }
+
+    #[test]
+    fn test_non_subsequence_rejected() {
+        assert!(match_score("xyz", "GetFileName").is_none());
+        assert!(match_score("", "anything").is_some());
+    }
+
+    #[test]
+    fn test_rank_caps_and_flags_incomplete() {
+        let pool: Vec<CompletionItem> = (0..MAX_COMPLETION_RESULTS + 50)
+            .map(|i| item(&format!("var{}", i)))
+            .collect();
+
+        let (items, is_incomplete) = rank_completions("var", &pool);
+        assert_eq!(items.len(), MAX_COMPLETION_RESULTS);
+        assert!(is_incomplete);
+
+        let (items, is_incomplete) = rank_completions("var1", &pool[..10]);
+        assert!(items.len() <= 10);
+        assert!(!is_incomplete);
+    }
+
+    #[test]
+    fn test_rank_orders_best_first() {
+        let pool = vec![item("LoadPicture"), item("slurp"), item("lp_count")];
+        let (items, _) = rank_completions("lp", &pool);
+        // Both boundary matchers beat the label where the hits sit mid-word
+        assert_eq!(items.last().unwrap().label, "slurp");
+    }
+}
@@ -4,24 +4,56 @@
 //! Includes a symbol table for precise position-based lookups.
 
 mod builder;
+mod interner;
+mod matcher;
 mod position;
 mod scope;
 mod symbol;
 mod symbol_table;
 
 // Re-export symbol table types
-pub use builder::build_symbol_table;
+pub use builder::{build_symbol_table, update_symbol_table};
+pub use interner::{intern, Name, NameId};
+pub use matcher::{match_score, rank_completions, MAX_COMPLETION_RESULTS};
 pub use position::{SourcePosition, SourceRange};
 pub use scope::{Scope, ScopeId, ScopeKind};
 pub use symbol::{ParameterInfo, Symbol, SymbolId, SymbolKind, TypeInfo, Visibility};
-pub use symbol_table::{SymbolReference, SymbolTable};
+pub use symbol_table::{SymbolReference, SymbolTable, UnresolvedReference};
 
 use std::collections::HashMap;
+use std::sync::{Arc, RwLock};
 
+use once_cell::sync::Lazy;
 use tower_lsp::lsp_types::*;
 
 use crate::parser::{Procedure, ProcedureType, Vb6Ast, Visibility as AstVisibility};
 
+/// Cached diagnostics from the previous analysis of a document, split by
+/// the scope of the pass that produced them.
+///
+/// Procedure entries are keyed by procedure kind and name and are reused
+/// when no edit touched the procedure's lines; module-wide entries are
+/// refreshed only by a full analysis (open/save), so keystroke-time
+/// analyses pay only for the procedures that actually changed.
+#[derive(Debug, Default)]
+pub struct DiagnosticCache {
+    /// Set by a full analysis; an incremental analysis against an
+    /// unpopulated cache (fresh document, dropped stale results) falls
+    /// back to a full pass rather than serving empty module diagnostics
+    populated: bool,
+    procedures: HashMap<String, ProcedureEntry>,
+    module: Vec<Diagnostic>,
+}
+
+/// Per-procedure diagnostics plus the procedure's start line when they
+/// were computed, so a clean procedure that merely moved can have its
+/// diagnostics shifted instead of recomputed
+#[derive(Debug)]
+struct ProcedureEntry {
+    start_line: usize,
+    diagnostics: Vec<Diagnostic>,
+}
+
 /// Code analyzer with symbol table support
 pub struct Analyzer {
     // Analysis state (reserved for future use)
@@ -36,94 +68,93 @@ impl Analyzer {
     // Legacy AST-based methods (for compatibility)
     // ==========================================
 
-    /// Analyze AST and produce diagnostics
+    /// Analyze AST and produce diagnostics (full pass, throwaway cache)
     pub fn analyze(&self, ast: &Vb6Ast) -> Vec<Diagnostic> {
+        self.analyze_full(ast, &mut DiagnosticCache::default())
+    }
+
+    /// Full analysis: recompute every per-procedure check and the
+    /// module-wide passes, repopulating the cache. Runs on open and save.
+    pub fn analyze_full(&self, ast: &Vb6Ast, cache: &mut DiagnosticCache) -> Vec<Diagnostic> {
         let mut diagnostics = Vec::new();
 
-        // Check for duplicate declarations
-        let mut var_names: HashMap<String, usize> = HashMap::new();
-        for var in &ast.variables {
-            if let Some(&first_line) = var_names.get(&var.name) {
-                diagnostics.push(Diagnostic {
-                    range: Range {
-                        start: Position {
-                            line: var.line as u32,
-                            character: 0,
-                        },
-                        end: Position {
-                            line: var.line as u32,
-                            character: var.name.len() as u32,
-                        },
-                    },
-                    severity: Some(DiagnosticSeverity::WARNING),
-                    message: format!(
-                        "Variable '{}' already declared at line {}",
-                        var.name,
-                        first_line + 1
-                    ),
-                    source: Some("vb6-lsp".to_string()),
-                    ..Default::default()
-                });
-            } else {
-                var_names.insert(var.name.clone(), var.line);
-            }
+        cache.procedures.clear();
+        for proc in &ast.procedures {
+            let proc_diags = procedure_diagnostics(proc);
+            diagnostics.extend(proc_diags.iter().cloned());
+            cache.procedures.insert(
+                procedure_key(proc),
+                ProcedureEntry {
+                    start_line: proc.line,
+                    diagnostics: proc_diags,
+                },
+            );
         }
 
-        // Check for procedures without End Sub/Function
-        for proc in &ast.procedures {
-            if proc.end_line.is_none() {
-                diagnostics.push(Diagnostic {
-                    range: Range {
-                        start: Position {
-                            line: proc.line as u32,
-                            character: 0,
-                        },
-                        end: Position {
-                            line: proc.line as u32,
-                            character: 50,
-                        },
-                    },
-                    severity: Some(DiagnosticSeverity::ERROR),
-                    message: format!(
-                        "{} '{}' is missing End statement",
-                        match proc.proc_type {
-                            ProcedureType::Sub => "Sub",
-                            ProcedureType::Function => "Function",
-                            _ => "Property",
-                        },
-                        proc.name
-                    ),
-                    source: Some("vb6-lsp".to_string()),
-                    ..Default::default()
-                });
-            }
+        cache.module = module_diagnostics(ast);
+        diagnostics.extend(cache.module.iter().cloned());
+        cache.populated = true;
+
+        diagnostics
+    }
+
+    /// Incremental analysis for keystroke-time diagnostics.
+    ///
+    /// Only procedures whose lines intersect an edit or a changed syntax
+    /// range are re-checked; cached results for procedures that merely
+    /// moved are shifted to their new start line. Module-wide passes are
+    /// not re-run — their diagnostics from the last full analysis are
+    /// shifted to follow the edits and republished, which keeps them
+    /// visible between saves without paying for the passes per keystroke.
+    pub fn analyze_incremental(
+        &self,
+        ast: &Vb6Ast,
+        edits: &[tree_sitter::InputEdit],
+        changed: &[tree_sitter::Range],
+        cache: &mut DiagnosticCache,
+    ) -> Vec<Diagnostic> {
+        if !cache.populated {
+            return self.analyze_full(ast, cache);
         }
 
-        // Warn about Option Explicit
-        if !ast
-            .options
-            .iter()
-            .any(|o| o.to_uppercase().contains("EXPLICIT"))
-        {
-            diagnostics.push(Diagnostic {
-                range: Range {
-                    start: Position {
-                        line: 0,
-                        character: 0,
-                    },
-                    end: Position {
-                        line: 0,
-                        character: 0,
-                    },
+        let dirty = dirty_line_spans(edits, changed);
+        let mut procedures = HashMap::with_capacity(ast.procedures.len());
+        let mut diagnostics = Vec::new();
+
+        for proc in &ast.procedures {
+            let key = procedure_key(proc);
+            // A procedure with no End extends to the end of the file as
+            // far as dirtiness is concerned
+            let extent_end = proc.end_line.unwrap_or(usize::MAX);
+            let is_dirty = dirty
+                .iter()
+                .any(|&(start, end)| start <= extent_end && proc.line <= end);
+
+            let entry = match cache.procedures.remove(&key) {
+                Some(mut entry) if !is_dirty => {
+                    shift_lines(
+                        &mut entry.diagnostics,
+                        proc.line as i64 - entry.start_line as i64,
+                    );
+                    entry.start_line = proc.line;
+                    entry
+                }
+                _ => ProcedureEntry {
+                    start_line: proc.line,
+                    diagnostics: procedure_diagnostics(proc),
                 },
-                severity: Some(DiagnosticSeverity::INFORMATION),
-                message: "Consider adding 'Option Explicit' to require variable declarations"
-                    .to_string(),
-                source: Some("vb6-lsp".to_string()),
-                ..Default::default()
-            });
+            };
+
+            diagnostics.extend(entry.diagnostics.iter().cloned());
+            procedures.insert(key, entry);
         }
 
+        // Entries left in the old map belong to deleted procedures
+        cache.procedures = procedures;
+
+        shift_past_edits(&mut cache.module, edits);
+        diagnostics.extend(cache.module.iter().cloned());
+
         diagnostics
     }
 
@@ -192,7 +223,7 @@ impl Analyzer {
         }
 
         // Add keywords
-        items.extend(self.get_keyword_completions());
+        items.extend(self.get_keyword_completions().iter().cloned());
 
         items
     }
@@ -517,7 +548,7 @@ impl Analyzer {
         }
 
         // Add keywords
-        items.extend(self.get_keyword_completions());
+        items.extend(self.get_keyword_completions().iter().cloned());
 
         items
     }
@@ -570,63 +601,7 @@ impl Analyzer {
         if symbol.kind == SymbolKind::FormControl {
             let type_name = symbol.type_info.as_ref()?.name.clone();
             let control = crate::controls::get_control(&type_name)?;
-
-            let mut completions = Vec::new();
-
-            // Add properties
-            for prop in control.properties {
-                let mut item = CompletionItem {
-                    label: prop.name.to_string(),
-                    kind: Some(CompletionItemKind::PROPERTY),
-                    detail: Some(prop.description.to_string()),
-                    documentation: Some(Documentation::String(format!(
-                        "**Type:** {}\n\n{}\n\n**Default:** {}",
-                        prop.property_type.vb6_type(),
-                        prop.description,
-                        prop.default_value.unwrap_or("(none)")
-                    ))),
-                    insert_text: None,
-                    insert_text_format: None,
-                    ..Default::default()
-                };
-
-                // For enum properties, show valid values
-                if !prop.valid_values.is_empty() {
-                    let mut doc = format!(
-                        "**Type:** {}\n\n{}\n\n**Valid Values:**\n",
-                        prop.property_type.vb6_type(),
-                        prop.description
-                    );
-                    for value in prop.valid_values.iter().take(10) {
-                        doc.push_str(&format!("\n- `{}` ({}): {}", value.value, value.name, value.description));
-                    }
-                    if prop.valid_values.len() > 10 {
-                        doc.push_str(&format!("\n- ... and {} more values", prop.valid_values.len() - 10));
-                    }
-                    item.documentation = Some(Documentation::String(doc));
-                }
-
-                completions.push(item);
-            }
-
-            // Add methods
-            for method in control.methods {
-                completions.push(CompletionItem {
-                    label: method.name.to_string(),
-                    kind: Some(CompletionItemKind::METHOD),
-                    detail: Some(method.description.to_string()),
-                    documentation: Some(Documentation::String(format!(
-                        "{}\n\n**Signature:** `{}`",
-                        method.description,
-                        method.signature
-                    ))),
-                    insert_text: Some(format!("{}($1)", method.name)),
-                    insert_text_format: Some(InsertTextFormat::SNIPPET),
-                    ..Default::default()
-                });
-            }
-
-            return Some(completions);
+            return Some(control_member_completions(control).as_ref().clone());
         }
 
         None
@@ -644,7 +619,7 @@ impl Analyzer {
 
             #[allow(deprecated)]
             symbols.push(DocumentSymbol {
-                name: symbol.name.clone(),
+                name: symbol.name.to_string(),
                 detail: symbol.type_info.as_ref().map(|t| t.display()),
                 kind: symbol.kind.to_lsp(),
                 range: symbol.definition_range.to_lsp(),
@@ -674,7 +649,7 @@ impl Analyzer {
             .map(|symbol| {
                 #[allow(deprecated)]
                 DocumentSymbol {
-                    name: symbol.name.clone(),
+                    name: symbol.name.to_string(),
                     detail: symbol.type_info.as_ref().map(|t| t.display()),
                     kind: symbol.kind.to_lsp(),
                     range: symbol.definition_range.to_lsp(),
@@ -697,7 +672,7 @@ impl Analyzer {
         let detail = symbol.type_info.as_ref().map(|t| t.display());
 
         CompletionItem {
-            label: symbol.name.clone(),
+            label: symbol.name.to_string(),
             kind: Some(symbol.kind.to_completion_kind()),
             detail,
             documentation: symbol
@@ -718,9 +693,200 @@ impl Analyzer {
         }
     }
 
-    fn get_keyword_completions(&self) -> Vec<CompletionItem> {
-        let keywords = [
-            "If",
+    fn get_keyword_completions(&self) -> &'static [CompletionItem] {
+        &KEYWORD_COMPLETIONS
+    }
+
+    /// Extract word at position from source
+    fn word_at_position(&self, source: &str, position: Position) -> Option<String> {
+        let lines: Vec<&str> = source.lines().collect();
+        let line = lines.get(position.line as usize)?;
+        let col = position.character as usize;
+
+        if col > line.len() {
+            return None;
+        }
+
+        // Find word boundaries
+        let chars: Vec<char> = line.chars().collect();
+
+        let mut start = col;
+        while start > 0 && is_identifier_char(chars[start - 1]) {
+            start -= 1;
+        }
+
+        let mut end = col;
+        while end < chars.len() && is_identifier_char(chars[end]) {
+            end += 1;
+        }
+
+        if start == end {
+            None
+        } else {
+            Some(chars[start..end].iter().collect())
+        }
+    }
+}
+
+/// Cache key for a procedure: kind plus case-folded name (Property
+/// Get/Let/Set share a name, so the kind disambiguates)
+fn procedure_key(proc: &Procedure) -> String {
+    format!("{:?} {}", proc.proc_type, proc.name.to_lowercase())
+}
+
+/// Per-procedure checks (currently: missing End statement)
+fn procedure_diagnostics(proc: &Procedure) -> Vec<Diagnostic> {
+    let mut diagnostics = Vec::new();
+
+    if proc.end_line.is_none() {
+        diagnostics.push(Diagnostic {
+            range: Range {
+                start: Position {
+                    line: proc.line as u32,
+                    character: 0,
+                },
+                end: Position {
+                    line: proc.line as u32,
+                    character: 50,
+                },
+            },
+            severity: Some(DiagnosticSeverity::ERROR),
+            message: format!(
+                "{} '{}' is missing End statement",
+                match proc.proc_type {
+                    ProcedureType::Sub => "Sub",
+                    ProcedureType::Function => "Function",
+                    _ => "Property",
+                },
+                proc.name
+            ),
+            source: Some("vb6-lsp".to_string()),
+            ..Default::default()
+        });
+    }
+
+    diagnostics
+}
+
+/// Module-wide passes (duplicate declarations, Option Explicit); these
+/// scan whole-module state and so run only during full analyses
+fn module_diagnostics(ast: &Vb6Ast) -> Vec<Diagnostic> {
+    let mut diagnostics = Vec::new();
+
+    // Check for duplicate declarations
+    let mut var_names: HashMap<String, usize> = HashMap::new();
+    for var in &ast.variables {
+        if let Some(&first_line) = var_names.get(&var.name) {
+            diagnostics.push(Diagnostic {
+                range: Range {
+                    start: Position {
+                        line: var.line as u32,
+                        character: 0,
+                    },
+                    end: Position {
+                        line: var.line as u32,
+                        character: var.name.len() as u32,
+                    },
+                },
+                severity: Some(DiagnosticSeverity::WARNING),
+                message: format!(
+                    "Variable '{}' already declared at line {}",
+                    var.name,
+                    first_line + 1
+                ),
+                source: Some("vb6-lsp".to_string()),
+                ..Default::default()
+            });
+        } else {
+            var_names.insert(var.name.clone(), var.line);
+        }
+    }
+
+    // Warn about Option Explicit
+    if !ast
+        .options
+        .iter()
+        .any(|o| o.to_uppercase().contains("EXPLICIT"))
+    {
+        diagnostics.push(Diagnostic {
+            range: Range {
+                start: Position {
+                    line: 0,
+                    character: 0,
+                },
+                end: Position {
+                    line: 0,
+                    character: 0,
+                },
+            },
+            severity: Some(DiagnosticSeverity::INFORMATION),
+            message: "Consider adding 'Option Explicit' to require variable declarations"
+                .to_string(),
+            source: Some("vb6-lsp".to_string()),
+            ..Default::default()
+        });
+    }
+
+    diagnostics
+}
+
+/// Inclusive line spans touched by the edits or by syntax changes. Edit
+/// spans are included alongside `Tree::changed_ranges` output because
+/// token-content edits that leave the tree shape intact may not appear
+/// in the changed ranges.
+fn dirty_line_spans(
+    edits: &[tree_sitter::InputEdit],
+    changed: &[tree_sitter::Range],
+) -> Vec<(usize, usize)> {
+    let mut spans = Vec::with_capacity(edits.len() + changed.len());
+    for edit in edits {
+        spans.push((
+            edit.start_position.row,
+            edit.old_end_position.row.max(edit.new_end_position.row),
+        ));
+    }
+    for range in changed {
+        spans.push((range.start_point.row, range.end_point.row));
+    }
+    spans
+}
+
+/// Shift every diagnostic by a whole number of lines (a clean procedure
+/// moves rigidly, so one delta applies to all of its diagnostics)
+fn shift_lines(diagnostics: &mut [Diagnostic], delta: i64) {
+    if delta == 0 {
+        return;
+    }
+    for diag in diagnostics.iter_mut() {
+        diag.range.start.line = (diag.range.start.line as i64 + delta).max(0) as u32;
+        diag.range.end.line = (diag.range.end.line as i64 + delta).max(0) as u32;
+    }
+}
+
+/// Shift diagnostics located after each edit by the edit's net line
+/// delta, keeping cached module-wide results anchored to the right lines
+/// between full analyses
+fn shift_past_edits(diagnostics: &mut [Diagnostic], edits: &[tree_sitter::InputEdit]) {
+    for edit in edits {
+        let old_end = edit.old_end_position.row as i64;
+        let delta = edit.new_end_position.row as i64 - old_end;
+        if delta == 0 {
+            continue;
+        }
+        for diag in diagnostics.iter_mut() {
+            if (diag.range.start.line as i64) > old_end {
+                diag.range.start.line = (diag.range.start.line as i64 + delta).max(0) as u32;
+                diag.range.end.line = (diag.range.end.line as i64 + delta).max(0) as u32;
+            }
+        }
+    }
+}
+
+/// Keyword completion items, built once at first use; per-request cost
+/// is only the clone into the response
+static KEYWORD_COMPLETIONS: Lazy<Vec<CompletionItem>> = Lazy::new(|| {
+    let keywords = [
+        "If",
             "Then",
             "Else",
             "ElseIf",
@@ -768,47 +934,101 @@ impl Analyzer {
             "End Type",
             "Enum",
             "End Enum",
-        ];
+    ];
 
-        keywords
-            .iter()
-            .map(|&kw| CompletionItem {
-                label: kw.to_string(),
-                kind: Some(CompletionItemKind::KEYWORD),
-                ..Default::default()
-            })
-            .collect()
+    keywords
+        .iter()
+        .map(|&kw| CompletionItem {
+            label: kw.to_string(),
+            kind: Some(CompletionItemKind::KEYWORD),
+            ..Default::default()
+        })
+        .collect()
+});
+
+/// Member completion lists per control type, built once per control on
+/// first request and served as shared vectors afterwards (the registry
+/// behind them is static, so these never go stale)
+static CONTROL_MEMBER_COMPLETIONS: Lazy<RwLock<HashMap<&'static str, Arc<Vec<CompletionItem>>>>> =
+    Lazy::new(|| RwLock::new(HashMap::new()));
+
+/// Get (building on first use) the member completions for a control
+fn control_member_completions(
+    control: &'static crate::controls::ControlDef,
+) -> Arc<Vec<CompletionItem>> {
+    if let Some(items) = CONTROL_MEMBER_COMPLETIONS.read().unwrap().get(control.name) {
+        return Arc::clone(items);
     }
 
-    /// Extract word at position from source
-    fn word_at_position(&self, source: &str, position: Position) -> Option<String> {
-        let lines: Vec<&str> = source.lines().collect();
-        let line = lines.get(position.line as usize)?;
-        let col = position.character as usize;
-
-        if col > line.len() {
-            return None;
-        }
-
-        // Find word boundaries
-        let chars: Vec<char> = line.chars().collect();
+    let items = Arc::new(build_control_member_completions(control));
+    CONTROL_MEMBER_COMPLETIONS
+        .write()
+        .unwrap()
+        .entry(control.name)
+        .or_insert_with(|| Arc::clone(&items))
+        .clone()
+}
 
-        let mut start = col;
-        while start > 0 && is_identifier_char(chars[start - 1]) {
-            start -= 1;
+/// Build property and method completion items for a control
+fn build_control_member_completions(
+    control: &'static crate::controls::ControlDef,
+) -> Vec<CompletionItem> {
+    let mut completions = Vec::new();
+
+    // Add properties
+    for prop in control.properties {
+        let mut item = CompletionItem {
+            label: prop.name.to_string(),
+            kind: Some(CompletionItemKind::PROPERTY),
+            detail: Some(prop.description.to_string()),
+            documentation: Some(Documentation::String(format!(
+                "**Type:** {}\n\n{}\n\n**Default:** {}",
+                prop.property_type.vb6_type(),
+                prop.description,
+                prop.default_value.unwrap_or("(none)")
+            ))),
+            insert_text: None,
+            insert_text_format: None,
+            ..Default::default()
+        };
+
+        // For enum properties, show valid values
+        if !prop.valid_values.is_empty() {
+            let mut doc = format!(
+                "**Type:** {}\n\n{}\n\n**Valid Values:**\n",
+                prop.property_type.vb6_type(),
+                prop.description
+            );
+            for value in prop.valid_values.iter().take(10) {
+                doc.push_str(&format!("\n- `{}` ({}): {}", value.value, value.name, value.description));
+            }
+            if prop.valid_values.len() > 10 {
+                doc.push_str(&format!("\n- ... and {} more values", prop.valid_values.len() - 10));
+            }
+            item.documentation = Some(Documentation::String(doc));
         }
 
-        let mut end = col;
-        while end < chars.len() && is_identifier_char(chars[end]) {
-            end += 1;
-        }
+        completions.push(item);
+    }
 
-        if start == end {
-            None
-        } else {
-            Some(chars[start..end].iter().collect())
-        }
+    // Add methods
+    for method in control.methods {
+        completions.push(CompletionItem {
+            label: method.name.to_string(),
+            kind: Some(CompletionItemKind::METHOD),
+            detail: Some(method.description.to_string()),
+            documentation: Some(Documentation::String(format!(
+                "{}\n\n**Signature:** `{}`",
+                method.description,
+                method.signature
+            ))),
+            insert_text: Some(format!("{}($1)", method.name)),
+            insert_text_format: Some(InsertTextFormat::SNIPPET),
+            ..Default::default()
+        });
     }
+
+    completions
 }
 
 impl Default for Analyzer {
@@ -821,3 +1041,115 @@ impl Default for Analyzer {
 fn is_identifier_char(c: char) -> bool {
     c.is_alphanumeric() || c == '_'
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tree_sitter::{InputEdit, Point};
+
+    fn sub(name: &str, line: usize, end_line: Option<usize>) -> Procedure {
+        Procedure {
+            name: name.to_string(),
+            proc_type: ProcedureType::Sub,
+            visibility: AstVisibility::Public,
+            line,
+            parameters: Vec::new(),
+            return_type: None,
+            end_line,
+        }
+    }
+
+    /// Edit inserting `count` blank lines at the start of `row`
+    fn insert_lines_edit(row: usize, count: usize) -> InputEdit {
+        InputEdit {
+            start_byte: 0,
+            old_end_byte: 0,
+            new_end_byte: count,
+            start_position: Point { row, column: 0 },
+            old_end_position: Point { row, column: 0 },
+            new_end_position: Point {
+                row: row + count,
+                column: 0,
+            },
+        }
+    }
+
+    #[test]
+    fn test_full_analysis_populates_cache() {
+        let analyzer = Analyzer::new();
+        let mut ast = Vb6Ast::new();
+        ast.procedures.push(sub("Broken", 2, None));
+
+        let mut cache = DiagnosticCache::default();
+        let diagnostics = analyzer.analyze_full(&ast, &mut cache);
+
+        assert!(cache.populated);
+        assert_eq!(cache.procedures.len(), 1);
+        // Missing End error plus the Option Explicit suggestion
+        assert_eq!(diagnostics.len(), 2);
+    }
+
+    #[test]
+    fn test_incremental_shifts_clean_procedures() {
+        let analyzer = Analyzer::new();
+        let mut ast = Vb6Ast::new();
+        ast.procedures.push(sub("Broken", 2, None));
+
+        let mut cache = DiagnosticCache::default();
+        analyzer.analyze_full(&ast, &mut cache);
+
+        // Two lines inserted at the top: the procedure moves to line 4
+        // without being touched
+        let mut moved = Vb6Ast::new();
+        moved.options.push("Option Explicit".to_string());
+        moved.procedures.push(sub("Broken", 4, None));
+
+        let edits = [insert_lines_edit(0, 2)];
+        let diagnostics = analyzer.analyze_incremental(&moved, &edits, &[], &mut cache);
+
+        let missing_end = diagnostics
+            .iter()
+            .find(|d| d.message.contains("missing End"))
+            .expect("cached procedure diagnostic survives the move");
+        assert_eq!(missing_end.range.start.line, 4);
+
+        // The module pass was not re-run: the cached Option Explicit
+        // suggestion is still served even though the option now exists
+        assert!(diagnostics
+            .iter()
+            .any(|d| d.message.contains("Option Explicit")));
+    }
+
+    #[test]
+    fn test_incremental_rechecks_dirty_procedure() {
+        let analyzer = Analyzer::new();
+        let mut ast = Vb6Ast::new();
+        ast.procedures.push(sub("Broken", 2, None));
+
+        let mut cache = DiagnosticCache::default();
+        analyzer.analyze_full(&ast, &mut cache);
+
+        // The user types the End Sub on line 5; the procedure intersects
+        // the edit and is re-checked
+        let mut fixed = Vb6Ast::new();
+        fixed.procedures.push(sub("Broken", 2, Some(5)));
+
+        let edits = [insert_lines_edit(5, 0)];
+        let diagnostics = analyzer.analyze_incremental(&fixed, &edits, &[], &mut cache);
+
+        assert!(!diagnostics.iter().any(|d| d.message.contains("missing End")));
+    }
+
+    #[test]
+    fn test_incremental_falls_back_to_full_when_unpopulated() {
+        let analyzer = Analyzer::new();
+        let mut ast = Vb6Ast::new();
+        ast.procedures.push(sub("Broken", 2, None));
+
+        let mut cache = DiagnosticCache::default();
+        let diagnostics = analyzer.analyze_incremental(&ast, &[], &[], &mut cache);
+
+        assert!(cache.populated);
+        assert_eq!(diagnostics.len(), 2);
+    }
+}
@@ -6,7 +6,7 @@
 use std::cmp::Ordering;
 
 /// A precise position in source code (0-indexed line and column)
-#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default, serde::Serialize, serde::Deserialize)]
 pub struct SourcePosition {
     pub line: u32,
     pub column: u32,
@@ -58,7 +58,7 @@ impl PartialOrd for SourcePosition {
 }
 
 /// A range in source code with start and end positions
-#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default, serde::Serialize, serde::Deserialize)]
 pub struct SourceRange {
     pub start: SourcePosition,
     pub end: SourcePosition,
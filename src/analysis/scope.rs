@@ -4,15 +4,16 @@
 
 use std::collections::HashMap;
 
+use super::interner::{self, NameId};
 use super::position::SourceRange;
 use super::symbol::SymbolId;
 
 /// Unique identifier for a scope
-#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default, serde::Serialize, serde::Deserialize)]
 pub struct ScopeId(pub u32);
 
 /// The type of scope
-#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, serde::Serialize, serde::Deserialize)]
 pub enum ScopeKind {
     /// Module-level scope (file scope)
     Module,
@@ -46,7 +47,7 @@ impl ScopeKind {
 }
 
 /// A scope in the scope hierarchy
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, serde::Serialize, serde::Deserialize)]
 pub struct Scope {
     /// Unique identifier
     pub id: ScopeId,
@@ -56,8 +57,12 @@ pub struct Scope {
     pub parent: Option<ScopeId>,
     /// Range covered by this scope
     pub range: SourceRange,
-    /// Symbols declared in this scope (lowercase name -> symbol id)
-    symbols: HashMap<String, SymbolId>,
+    /// Symbols declared in this scope (interned case-folded name id ->
+    /// symbol id, so lookups compare ids instead of strings). Interner
+    /// ids are per-process, so this map is rebuilt after deserialization
+    /// instead of being persisted.
+    #[serde(skip)]
+    symbols: HashMap<NameId, SymbolId>,
     /// Child scopes (in document order)
     pub children: Vec<ScopeId>,
     /// For WithBlock: the object expression being referenced
@@ -83,13 +88,22 @@ impl Scope {
 
     /// Add a symbol to this scope
     pub fn add_symbol(&mut self, name: &str, symbol_id: SymbolId) {
-        // Use lowercase for case-insensitive lookup
-        self.symbols.insert(name.to_lowercase(), symbol_id);
+        // Intern for case-insensitive id comparison on lookup
+        self.symbols.insert(interner::intern(name).id(), symbol_id);
     }
 
-    /// Look up a symbol by name in this scope only (case-insensitive)
+    /// Remove a symbol from this scope (case-insensitive)
+    pub fn remove_symbol(&mut self, name: &str) {
+        if let Some(id) = interner::folded_id(name) {
+            self.symbols.remove(&id);
+        }
+    }
+
+    /// Look up a symbol by name in this scope only (case-insensitive).
+    /// A name that was never interned cannot name any symbol, so the
+    /// interner miss doubles as a negative answer.
     pub fn lookup_local(&self, name: &str) -> Option<SymbolId> {
-        self.symbols.get(&name.to_lowercase()).copied()
+        self.symbols.get(&interner::folded_id(name)?).copied()
     }
 
     /// Get all symbols declared in this scope
@@ -104,7 +118,7 @@ impl Scope {
 
     /// Check if a symbol name exists in this scope
     pub fn has_symbol(&self, name: &str) -> bool {
-        self.symbols.contains_key(&name.to_lowercase())
+        interner::folded_id(name).map_or(false, |id| self.symbols.contains_key(&id))
     }
 
     /// Add a child scope
@@ -2,15 +2,16 @@
 //!
 //! Defines the Symbol struct and related types for the symbol table.
 
+use super::interner::Name;
 use super::position::SourceRange;
 use super::scope::ScopeId;
 
 /// Unique identifier for a symbol within the symbol table
-#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, serde::Serialize, serde::Deserialize)]
 pub struct SymbolId(pub u32);
 
 /// The kind of symbol
-#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, serde::Serialize, serde::Deserialize)]
 pub enum SymbolKind {
     // Module-level declarations
     Variable,
@@ -150,7 +151,7 @@ impl SymbolKind {
 }
 
 /// Visibility level for symbols
-#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default, serde::Serialize, serde::Deserialize)]
 pub enum Visibility {
     #[default]
     Private,
@@ -172,10 +173,10 @@ impl Visibility {
 }
 
 /// Type information for a symbol
-#[derive(Debug, Clone, PartialEq, Eq)]
+#[derive(Debug, Clone, PartialEq, Eq, serde::Serialize, serde::Deserialize)]
 pub struct TypeInfo {
-    /// The type name (e.g., "Integer", "String", "MyClass")
-    pub name: String,
+    /// The type name, interned (e.g., "Integer", "String", "MyClass")
+    pub name: Name,
     /// Whether this is an array type
     pub is_array: bool,
     /// Whether this is a New expression type (for classes)
@@ -183,7 +184,7 @@ pub struct TypeInfo {
 }
 
 impl TypeInfo {
-    pub fn new(name: impl Into<String>) -> Self {
+    pub fn new(name: impl Into<Name>) -> Self {
         Self {
             name: name.into(),
             is_array: false,
@@ -191,7 +192,7 @@ impl TypeInfo {
         }
     }
 
-    pub fn array(name: impl Into<String>) -> Self {
+    pub fn array(name: impl Into<Name>) -> Self {
         Self {
             name: name.into(),
             is_array: true,
@@ -204,16 +205,16 @@ impl TypeInfo {
         if self.is_array {
             format!("{}()", self.name)
         } else {
-            self.name.clone()
+            self.name.to_string()
         }
     }
 }
 
 /// Parameter information for procedures
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, serde::Serialize, serde::Deserialize)]
 pub struct ParameterInfo {
-    /// Parameter name
-    pub name: String,
+    /// Parameter name, interned
+    pub name: Name,
     /// Parameter type
     pub type_info: Option<TypeInfo>,
     /// Whether passed by reference (default in VB6)
@@ -243,7 +244,7 @@ impl ParameterInfo {
             parts.push("ByVal".to_string());
         }
 
-        parts.push(self.name.clone());
+        parts.push(self.name.to_string());
 
         if let Some(ref ti) = self.type_info {
             parts.push(format!("As {}", ti.display()));
@@ -258,12 +259,13 @@ impl ParameterInfo {
 }
 
 /// A symbol definition in the symbol table
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, serde::Serialize, serde::Deserialize)]
 pub struct Symbol {
     /// Unique identifier
     pub id: SymbolId,
-    /// Symbol name (case-preserved, but lookups are case-insensitive)
-    pub name: String,
+    /// Symbol name, interned (case-preserved, but lookups are
+    /// case-insensitive)
+    pub name: Name,
     /// Symbol kind
     pub kind: SymbolKind,
     /// Visibility
@@ -290,7 +292,7 @@ impl Symbol {
     /// Create a new symbol
     pub fn new(
         id: SymbolId,
-        name: String,
+        name: Name,
         kind: SymbolKind,
         visibility: Visibility,
         definition_range: SourceRange,
@@ -407,7 +409,7 @@ impl Symbol {
                 if let Some(ref val) = self.value {
                     format!("{} = {}", self.name, val)
                 } else {
-                    self.name.clone()
+                    self.name.to_string()
                 }
             }
             SymbolKind::TypeMember => {
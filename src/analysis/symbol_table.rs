@@ -6,12 +6,13 @@ use std::collections::HashMap;
 
 use tower_lsp::lsp_types::Url;
 
+use super::interner::Name;
 use super::position::{SourcePosition, SourceRange};
 use super::scope::{Scope, ScopeId, ScopeKind};
 use super::symbol::{ParameterInfo, Symbol, SymbolId, SymbolKind, TypeInfo, Visibility};
 
 /// A reference to a symbol (usage site)
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, serde::Serialize, serde::Deserialize)]
 pub struct SymbolReference {
     /// The symbol being referenced
     pub symbol_id: SymbolId,
@@ -25,17 +26,31 @@ pub struct SymbolReference {
     pub qualifying_reference: Option<Box<SymbolReference>>,
 }
 
+/// A use of a name that resolved to no local symbol.
+///
+/// Kept so cross-file find-all-references can locate uses of a public
+/// symbol declared in another module without re-parsing this one.
+#[derive(Debug, Clone, serde::Serialize, serde::Deserialize)]
+pub struct UnresolvedReference {
+    /// The referenced name, as written
+    pub name: super::interner::Name,
+    /// The range of this reference
+    pub range: SourceRange,
+}
+
 /// The complete symbol table for a document
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, serde::Serialize, serde::Deserialize)]
 pub struct SymbolTable {
     /// Document URI
     pub uri: Url,
 
-    /// All symbols, indexed by ID
-    symbols: Vec<Symbol>,
+    /// All symbols, indexed by ID. Removed symbols leave a `None` slot so
+    /// surviving IDs stay stable across incremental updates; slots are
+    /// reused by later insertions.
+    symbols: Vec<Option<Symbol>>,
 
-    /// All scopes, indexed by ID
-    scopes: Vec<Scope>,
+    /// All scopes, indexed by ID (same slot semantics as `symbols`)
+    scopes: Vec<Option<Scope>>,
 
     /// The module-level (root) scope
     pub module_scope: ScopeId,
@@ -43,17 +58,45 @@ pub struct SymbolTable {
     /// All references to symbols
     references: Vec<SymbolReference>,
 
+    /// Uses of names with no local declaration (candidates for
+    /// cross-file references)
+    unresolved: Vec<UnresolvedReference>,
+
     /// Spatial index: map from line number to symbols defined on that line
+    /// (rebuilt after deserialization)
+    #[serde(skip)]
     symbols_by_line: HashMap<u32, Vec<SymbolId>>,
 
     /// Spatial index: map from line number to scopes that contain that line
+    /// (rebuilt after deserialization)
+    #[serde(skip)]
     scopes_by_line: HashMap<u32, Vec<ScopeId>>,
 
-    /// Next symbol ID to allocate
-    next_symbol_id: u32,
+    /// Freed symbol slots available for reuse
+    free_symbol_slots: Vec<u32>,
+
+    /// Freed scope slots available for reuse
+    free_scope_slots: Vec<u32>,
+
+    /// Indices into `references`, sorted by range start; rebuilt by
+    /// `finalize_references` for O(log n) position lookups
+    #[serde(skip)]
+    ref_order: Vec<u32>,
+
+    /// Per-symbol reference postings (indices into `references`)
+    #[serde(skip)]
+    refs_by_symbol: HashMap<SymbolId, Vec<u32>>,
 
-    /// Next scope ID to allocate
-    next_scope_id: u32,
+    /// Whether the reference indexes are stale (mutations set this;
+    /// queries fall back to linear scans until the next finalize)
+    #[serde(skip, default = "default_true")]
+    ref_index_dirty: bool,
+}
+
+/// serde default for the skipped dirty flag: a freshly deserialized
+/// table has no indexes yet
+fn default_true() -> bool {
+    true
 }
 
 impl SymbolTable {
@@ -65,10 +108,14 @@ impl SymbolTable {
             scopes: Vec::new(),
             module_scope: ScopeId(0),
             references: Vec::new(),
+            unresolved: Vec::new(),
             symbols_by_line: HashMap::new(),
             scopes_by_line: HashMap::new(),
-            next_symbol_id: 0,
-            next_scope_id: 0,
+            free_symbol_slots: Vec::new(),
+            free_scope_slots: Vec::new(),
+            ref_order: Vec::new(),
+            refs_by_symbol: HashMap::new(),
+            ref_index_dirty: true,
         };
 
         // Create the module scope (covers entire file)
@@ -88,15 +135,18 @@ impl SymbolTable {
     /// Create a new symbol and add it to the table
     pub fn create_symbol(
         &mut self,
-        name: String,
+        name: impl Into<Name>,
         kind: SymbolKind,
         visibility: Visibility,
         definition_range: SourceRange,
         name_range: SourceRange,
         scope_id: ScopeId,
     ) -> SymbolId {
-        let id = SymbolId(self.next_symbol_id);
-        self.next_symbol_id += 1;
+        let name = name.into();
+        let id = match self.free_symbol_slots.pop() {
+            Some(slot) => SymbolId(slot),
+            None => SymbolId(self.symbols.len() as u32),
+        };
 
         let symbol = Symbol::new(
             id,
@@ -114,22 +164,30 @@ impl SymbolTable {
         }
 
         // Add to scope
-        if let Some(scope) = self.scopes.get_mut(scope_id.0 as usize) {
+        if let Some(scope) = self
+            .scopes
+            .get_mut(scope_id.0 as usize)
+            .and_then(|s| s.as_mut())
+        {
             scope.add_symbol(&name, id);
         }
 
-        self.symbols.push(symbol);
+        if (id.0 as usize) < self.symbols.len() {
+            self.symbols[id.0 as usize] = Some(symbol);
+        } else {
+            self.symbols.push(Some(symbol));
+        }
         id
     }
 
     /// Get a symbol by ID
     pub fn get_symbol(&self, id: SymbolId) -> Option<&Symbol> {
-        self.symbols.get(id.0 as usize)
+        self.symbols.get(id.0 as usize).and_then(|s| s.as_ref())
     }
 
     /// Get a mutable symbol by ID
     pub fn get_symbol_mut(&mut self, id: SymbolId) -> Option<&mut Symbol> {
-        self.symbols.get_mut(id.0 as usize)
+        self.symbols.get_mut(id.0 as usize).and_then(|s| s.as_mut())
     }
 
     /// Set type info for a symbol
@@ -178,8 +236,10 @@ impl SymbolTable {
         parent: Option<ScopeId>,
         range: SourceRange,
     ) -> ScopeId {
-        let id = ScopeId(self.next_scope_id);
-        self.next_scope_id += 1;
+        let id = match self.free_scope_slots.pop() {
+            Some(slot) => ScopeId(slot),
+            None => ScopeId(self.scopes.len() as u32),
+        };
 
         let scope = Scope::new(id, kind, parent, range);
 
@@ -191,23 +251,31 @@ impl SymbolTable {
 
         // Add as child to parent
         if let Some(parent_id) = parent {
-            if let Some(parent_scope) = self.scopes.get_mut(parent_id.0 as usize) {
+            if let Some(parent_scope) = self
+                .scopes
+                .get_mut(parent_id.0 as usize)
+                .and_then(|s| s.as_mut())
+            {
                 parent_scope.add_child(id);
             }
         }
 
-        self.scopes.push(scope);
+        if (id.0 as usize) < self.scopes.len() {
+            self.scopes[id.0 as usize] = Some(scope);
+        } else {
+            self.scopes.push(Some(scope));
+        }
         id
     }
 
     /// Get a scope by ID
     pub fn get_scope(&self, id: ScopeId) -> Option<&Scope> {
-        self.scopes.get(id.0 as usize)
+        self.scopes.get(id.0 as usize).and_then(|s| s.as_ref())
     }
 
     /// Get a mutable scope by ID
     pub fn get_scope_mut(&mut self, id: ScopeId) -> Option<&mut Scope> {
-        self.scopes.get_mut(id.0 as usize)
+        self.scopes.get_mut(id.0 as usize).and_then(|s| s.as_mut())
     }
 
     /// Link a procedure symbol to its scope
@@ -243,6 +311,7 @@ impl SymbolTable {
             is_assignment,
             qualifying_reference: None,
         });
+        self.ref_index_dirty = true;
     }
 
     /// Add a qualified reference (member access)
@@ -261,16 +330,62 @@ impl SymbolTable {
             is_assignment,
             qualifying_reference: Some(Box::new(qualifying)),
         });
+        self.ref_index_dirty = true;
     }
 
     /// Get all references to a symbol
+    /// Record a use of a name that resolved to no local symbol
+    pub fn add_unresolved_reference(&mut self, name: super::interner::Name, range: SourceRange) {
+        self.unresolved.push(UnresolvedReference { name, range });
+    }
+
+    /// Uses of `name` (case-insensitive, VB6 style) that resolved to no
+    /// local symbol
+    pub fn unresolved_named<'a>(
+        &'a self,
+        name: &'a str,
+    ) -> impl Iterator<Item = &'a UnresolvedReference> {
+        self.unresolved
+            .iter()
+            .filter(move |u| u.name.as_str().eq_ignore_ascii_case(name))
+    }
+
     pub fn get_references(&self, symbol_id: SymbolId) -> Vec<&SymbolReference> {
+        if !self.ref_index_dirty {
+            if let Some(indices) = self.refs_by_symbol.get(&symbol_id) {
+                return indices
+                    .iter()
+                    .filter_map(|&i| self.references.get(i as usize))
+                    .collect();
+            }
+            return Vec::new();
+        }
         self.references
             .iter()
             .filter(|r| r.symbol_id == symbol_id)
             .collect()
     }
 
+    /// Rebuild the sorted-by-start reference index and per-symbol
+    /// postings. Called once after a build or incremental update so
+    /// position queries binary-search instead of scanning.
+    pub fn finalize_references(&mut self) {
+        self.ref_order = (0..self.references.len() as u32).collect();
+        let references = &self.references;
+        self.ref_order
+            .sort_by_key(|&i| references[i as usize].range.start);
+
+        self.refs_by_symbol.clear();
+        for (i, reference) in self.references.iter().enumerate() {
+            self.refs_by_symbol
+                .entry(reference.symbol_id)
+                .or_default()
+                .push(i as u32);
+        }
+
+        self.ref_index_dirty = false;
+    }
+
     // ==========================================
     // Query Methods
     // ==========================================
@@ -338,11 +453,9 @@ impl SymbolTable {
             }
         }
 
-        // Then check references
-        for reference in &self.references {
-            if reference.range.contains(pos) {
-                return self.get_symbol(reference.symbol_id);
-            }
+        // Then check references (binary search when the index is fresh)
+        if let Some(reference) = self.reference_at_position(pos) {
+            return self.get_symbol(reference.symbol_id);
         }
 
         None
@@ -350,7 +463,26 @@ impl SymbolTable {
 
     /// Find the reference at a specific position (if any)
     pub fn reference_at_position(&self, pos: SourcePosition) -> Option<&SymbolReference> {
-        self.references.iter().find(|r| r.range.contains(pos))
+        if self.ref_index_dirty {
+            return self.references.iter().find(|r| r.range.contains(pos));
+        }
+
+        // Binary search over references sorted by start position: the only
+        // candidates start at or before `pos`, and references never span
+        // lines, so scanning back within the position's line is enough.
+        let first_after = self
+            .ref_order
+            .partition_point(|&i| self.references[i as usize].range.start <= pos);
+        for &i in self.ref_order[..first_after].iter().rev() {
+            let reference = &self.references[i as usize];
+            if reference.range.start.line < pos.line {
+                break;
+            }
+            if reference.range.contains(pos) {
+                return Some(reference);
+            }
+        }
+        None
     }
 
     /// Get all symbols in a scope (not recursive)
@@ -372,12 +504,12 @@ impl SymbolTable {
 
     /// Get all symbols (for document outline)
     pub fn all_symbols(&self) -> impl Iterator<Item = &Symbol> {
-        self.symbols.iter()
+        self.symbols.iter().filter_map(|s| s.as_ref())
     }
 
     /// Get all symbols of a specific kind
     pub fn symbols_of_kind(&self, kind: SymbolKind) -> impl Iterator<Item = &Symbol> {
-        self.symbols.iter().filter(move |s| s.kind == kind)
+        self.all_symbols().filter(move |s| s.kind == kind)
     }
 
     /// Find definition of a symbol by name and position
@@ -415,10 +547,9 @@ impl SymbolTable {
             if let Some(scope) = self.get_scope(id) {
                 for symbol_id in scope.symbols() {
                     if let Some(symbol) = self.get_symbol(symbol_id) {
-                        let lower_name = symbol.name.to_lowercase();
-                        if !seen_names.contains(&lower_name) {
+                        // Interned name ids are already case-folded
+                        if seen_names.insert(symbol.name.id()) {
                             visible.push(symbol);
-                            seen_names.insert(lower_name);
                         }
                     }
                 }
@@ -433,28 +564,240 @@ impl SymbolTable {
 
     /// Get procedures (for document outline)
     pub fn procedures(&self) -> impl Iterator<Item = &Symbol> {
-        self.symbols.iter().filter(|s| s.kind.is_procedure())
+        self.all_symbols().filter(|s| s.kind.is_procedure())
     }
 
     /// Get all scopes
     pub fn all_scopes(&self) -> impl Iterator<Item = &super::scope::Scope> {
-        self.scopes.iter()
+        self.scopes.iter().filter_map(|s| s.as_ref())
     }
 
     /// Get the count of symbols
     pub fn symbol_count(&self) -> usize {
-        self.symbols.len()
+        self.symbols.len() - self.free_symbol_slots.len()
     }
 
     /// Get the count of scopes
     pub fn scope_count(&self) -> usize {
-        self.scopes.len()
+        self.scopes.len() - self.free_scope_slots.len()
     }
 
     /// Get the count of references
     pub fn reference_count(&self) -> usize {
         self.references.len()
     }
+
+    /// Rough resident size in bytes, for memory budget accounting.
+    /// Counts allocated slot capacity plus the spatial indexes; interned
+    /// names are shared across tables and not attributed here.
+    pub fn approx_bytes(&self) -> u64 {
+        use std::mem::size_of;
+
+        let symbols = self.symbols.capacity() * size_of::<Option<super::symbol::Symbol>>();
+        let scopes = self.scopes.capacity() * size_of::<Option<super::scope::Scope>>();
+        let references = self.references.capacity() * size_of::<SymbolReference>();
+        let unresolved = self.unresolved.capacity() * size_of::<UnresolvedReference>();
+        let line_index = (self.symbols_by_line.len() + self.scopes_by_line.len())
+            * (size_of::<u32>() + size_of::<Vec<SymbolId>>());
+
+        (symbols + scopes + references + unresolved + line_index) as u64
+    }
+
+    // ==========================================
+    // Incremental Update Support
+    // ==========================================
+
+    /// Shift all stored positions to account for a text edit, so symbols and
+    /// references outside the edited region stay accurate without a rebuild.
+    /// Positions inside the edited region are left as-is; callers are
+    /// expected to rebuild the enclosing procedure anyway.
+    pub fn shift_for_edit(&mut self, edit: &tree_sitter::InputEdit) {
+        let old_end = SourcePosition::from_ts_point(edit.old_end_position);
+        let new_end = SourcePosition::from_ts_point(edit.new_end_position);
+
+        let shift_pos = |pos: SourcePosition| -> SourcePosition {
+            if pos < old_end {
+                return pos;
+            }
+            if pos.line == old_end.line {
+                SourcePosition::new(new_end.line, new_end.column + (pos.column - old_end.column))
+            } else {
+                let delta = new_end.line as i64 - old_end.line as i64;
+                let line = (pos.line as i64 + delta).clamp(0, u32::MAX as i64 - 1) as u32;
+                SourcePosition::new(line, pos.column)
+            }
+        };
+
+        let shift_range = |range: &mut SourceRange| {
+            range.start = shift_pos(range.start);
+            range.end = shift_pos(range.end);
+        };
+
+        for symbol in self.symbols.iter_mut().filter_map(|s| s.as_mut()) {
+            shift_range(&mut symbol.definition_range);
+            shift_range(&mut symbol.name_range);
+            for param in &mut symbol.parameters {
+                shift_range(&mut param.range);
+                shift_range(&mut param.name_range);
+            }
+        }
+
+        for scope in self.scopes.iter_mut().filter_map(|s| s.as_mut()) {
+            shift_range(&mut scope.range);
+        }
+
+        for reference in &mut self.references {
+            shift_range(&mut reference.range);
+            if let Some(ref mut qualifying) = reference.qualifying_reference {
+                shift_range(&mut qualifying.range);
+            }
+        }
+
+        for unresolved in &mut self.unresolved {
+            shift_range(&mut unresolved.range);
+        }
+    }
+
+    /// Remove a symbol, freeing its slot and detaching it from its scope
+    pub fn remove_symbol(&mut self, id: SymbolId) {
+        let Some(symbol) = self.symbols.get_mut(id.0 as usize).and_then(|s| s.take()) else {
+            return;
+        };
+        if let Some(scope) = self
+            .scopes
+            .get_mut(symbol.scope_id.0 as usize)
+            .and_then(|s| s.as_mut())
+        {
+            scope.remove_symbol(&symbol.name);
+        }
+        self.free_symbol_slots.push(id.0);
+    }
+
+    /// Remove a scope together with its child scopes and every symbol
+    /// declared in them (used when a procedure is rebuilt incrementally)
+    pub fn remove_scope_subtree(&mut self, scope_id: ScopeId) {
+        let Some(scope) = self.scopes.get_mut(scope_id.0 as usize).and_then(|s| s.take()) else {
+            return;
+        };
+
+        for symbol_id in scope.symbols() {
+            if let Some(symbol) = self.symbols.get_mut(symbol_id.0 as usize) {
+                if symbol.take().is_some() {
+                    self.free_symbol_slots.push(symbol_id.0);
+                }
+            }
+        }
+
+        for child in &scope.children {
+            self.remove_scope_subtree(*child);
+        }
+
+        // Detach from the parent's child list
+        if let Some(parent_id) = scope.parent {
+            if let Some(parent) = self
+                .scopes
+                .get_mut(parent_id.0 as usize)
+                .and_then(|s| s.as_mut())
+            {
+                parent.children.retain(|c| *c != scope_id);
+            }
+        }
+
+        self.free_scope_slots.push(scope_id.0);
+    }
+
+    /// Drop references whose range falls inside the given range
+    /// (before re-collecting them for a rebuilt procedure)
+    pub fn remove_references_in_range(&mut self, range: SourceRange) {
+        self.references
+            .retain(|r| !(range.contains(r.range.start) && range.contains(r.range.end)));
+        self.unresolved
+            .retain(|u| !(range.contains(u.range.start) && range.contains(u.range.end)));
+        self.ref_index_dirty = true;
+    }
+
+    /// Drop references that point at removed symbols
+    pub fn prune_dead_references(&mut self) {
+        let symbols = &self.symbols;
+        self.references
+            .retain(|r| symbols.get(r.symbol_id.0 as usize).map_or(false, |s| s.is_some()));
+        self.ref_index_dirty = true;
+    }
+
+    /// Take all references pointing at a symbol out of the table (used when
+    /// a rebuilt procedure gets a fresh ID but outside references survive)
+    pub fn take_references_to(&mut self, id: SymbolId) -> Vec<SymbolReference> {
+        let mut taken = Vec::new();
+        let mut kept = Vec::with_capacity(self.references.len());
+        for reference in self.references.drain(..) {
+            if reference.symbol_id == id {
+                taken.push(reference);
+            } else {
+                kept.push(reference);
+            }
+        }
+        self.references = kept;
+        self.ref_index_dirty = true;
+        taken
+    }
+
+    /// Re-insert a reference taken out by `take_references_to`
+    pub fn push_reference(&mut self, reference: SymbolReference) {
+        self.references.push(reference);
+        self.ref_index_dirty = true;
+    }
+
+    /// Rebuild the line-keyed spatial indexes after positions have shifted
+    pub fn rebuild_spatial_indexes(&mut self) {
+        self.symbols_by_line.clear();
+        self.scopes_by_line.clear();
+
+        let mut symbol_lines = Vec::new();
+        for symbol in self.symbols.iter().filter_map(|s| s.as_ref()) {
+            symbol_lines.push((symbol.id, symbol.name_range));
+        }
+        for (id, name_range) in symbol_lines {
+            for line in name_range.start.line..=name_range.end.line {
+                self.symbols_by_line.entry(line).or_default().push(id);
+            }
+        }
+
+        let mut scope_lines = Vec::new();
+        for scope in self.scopes.iter().filter_map(|s| s.as_ref()) {
+            scope_lines.push((scope.id, scope.range));
+        }
+        for (id, range) in scope_lines {
+            let end_line = range.end.line.min(range.start.line + 10000);
+            for line in range.start.line..=end_line {
+                self.scopes_by_line.entry(line).or_default().push(id);
+            }
+        }
+    }
+
+    /// Rebuild all process-local state after deserialization.
+    ///
+    /// The on-disk cache persists only the symbols, scopes and references;
+    /// scope name maps (keyed by per-process interner ids), spatial
+    /// indexes and reference indexes are all derived, so a loaded table
+    /// must be rehydrated before it answers queries.
+    pub fn rehydrate(&mut self) {
+        let mut entries = Vec::new();
+        for symbol in self.symbols.iter().filter_map(|s| s.as_ref()) {
+            entries.push((symbol.name.clone(), symbol.id, symbol.scope_id));
+        }
+        for (name, id, scope_id) in entries {
+            if let Some(scope) = self
+                .scopes
+                .get_mut(scope_id.0 as usize)
+                .and_then(|s| s.as_mut())
+            {
+                scope.add_symbol(&name, id);
+            }
+        }
+
+        self.rebuild_spatial_indexes();
+        self.finalize_references();
+    }
 }
 
 #[cfg(test)]
@@ -545,6 +888,48 @@ mod tests {
         assert_eq!(scope, table.module_scope);
     }
 
+    #[test]
+    fn test_indexed_reference_lookup() {
+        let mut table = create_test_table();
+
+        let id = table.create_symbol(
+            "Counter".to_string(),
+            SymbolKind::Variable,
+            Visibility::Private,
+            SourceRange::new(SourcePosition::new(1, 0), SourcePosition::new(1, 20)),
+            SourceRange::new(SourcePosition::new(1, 4), SourcePosition::new(1, 11)),
+            table.module_scope,
+        );
+
+        // Add references out of order; finalize sorts them
+        let later = SourceRange::new(SourcePosition::new(9, 4), SourcePosition::new(9, 11));
+        let earlier = SourceRange::new(SourcePosition::new(3, 8), SourcePosition::new(3, 15));
+        table.add_reference(id, later, table.module_scope, true);
+        table.add_reference(id, earlier, table.module_scope, false);
+        table.finalize_references();
+
+        let hit = table.reference_at_position(SourcePosition::new(3, 10));
+        assert!(hit.is_some());
+        assert_eq!(hit.unwrap().symbol_id, id);
+        assert!(table
+            .reference_at_position(SourcePosition::new(3, 20))
+            .is_none());
+
+        assert_eq!(table.get_references(id).len(), 2);
+
+        // Mutations invalidate the index but queries stay correct
+        table.add_reference(
+            id,
+            SourceRange::new(SourcePosition::new(5, 0), SourcePosition::new(5, 7)),
+            table.module_scope,
+            false,
+        );
+        assert!(table
+            .reference_at_position(SourcePosition::new(5, 3))
+            .is_some());
+        assert_eq!(table.get_references(id).len(), 3);
+    }
+
     #[test]
     fn test_case_insensitive_lookup() {
         let mut table = create_test_table();
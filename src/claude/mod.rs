@@ -1,14 +1,75 @@
 //! Claude AI Integration
 //!
-//! Provides AI-powered code assistance using Claude Sonnet.
+//! Provides AI-powered code assistance using Claude Sonnet. Completed
+//! responses are kept in a small LRU cache keyed by operation and prompt
+//! hash, identical concurrent asks coalesce onto one HTTP call, long
+//! generations can stream progressively, and every call accepts an
+//! optional cancellation token so abandoned requests stop paying for
+//! latency and tokens.
+
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Mutex};
 
 use serde::{Deserialize, Serialize};
+use tokio::sync::broadcast;
+
+/// Completed responses kept per client; one response is at most a few KB
+const CACHE_CAPACITY: usize = 64;
+
+/// Cache and coalescing key: the operation name plus a hash of the full
+/// prompt (the prompt embeds all operation inputs, so equal hashes mean
+/// an equivalent ask)
+type CacheKey = (&'static str, u64);
+
+/// Cancellation flag shared between an LSP request handler and the API
+/// call it started. Cancelling wakes the call's select, which drops the
+/// HTTP future and aborts the transfer mid-flight.
+#[derive(Clone, Default)]
+pub struct CancelToken {
+    inner: Arc<CancelInner>,
+}
+
+#[derive(Default)]
+struct CancelInner {
+    cancelled: AtomicBool,
+    notify: tokio::sync::Notify,
+}
+
+impl CancelToken {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Signal cancellation; any call holding this token returns promptly
+    pub fn cancel(&self) {
+        self.inner.cancelled.store(true, Ordering::Release);
+        self.inner.notify.notify_waiters();
+    }
+
+    pub fn is_cancelled(&self) -> bool {
+        self.inner.cancelled.load(Ordering::Acquire)
+    }
+
+    /// Resolves once `cancel` has been called
+    async fn cancelled(&self) {
+        if self.is_cancelled() {
+            return;
+        }
+        self.inner.notify.notified().await;
+    }
+}
 
 /// Claude API client
 pub struct ClaudeClient {
     api_key: String,
     client: reqwest::Client,
     model: String,
+    /// LRU cache of completed responses
+    cache: Mutex<ResponseCache>,
+    /// One broadcast channel per ask currently on the wire; identical
+    /// concurrent asks subscribe instead of issuing their own call
+    in_flight: tokio::sync::Mutex<HashMap<CacheKey, broadcast::Sender<Result<String, String>>>>,
 }
 
 impl ClaudeClient {
@@ -17,6 +78,8 @@ impl ClaudeClient {
             api_key,
             client: reqwest::Client::new(),
             model: "claude-sonnet-4-20250514".to_string(),
+            cache: Mutex::new(ResponseCache::new()),
+            in_flight: tokio::sync::Mutex::new(HashMap::new()),
         }
     }
 
@@ -25,36 +88,63 @@ impl ClaudeClient {
         &self,
         code_context: &str,
         cursor_position: &str,
+        cancel: Option<&CancelToken>,
     ) -> Result<String, Box<dyn std::error::Error>> {
         let prompt = format!(
             "You are a Visual Basic 6 expert. Given the following VB6 code context, suggest a completion at the cursor position.\n\nCode:\n{}\n\nCursor at: {}\n\nProvide only the suggested completion, no explanations.",
             code_context, cursor_position
         );
 
-        self.send_message(&prompt).await
+        self.cached_message("completion", &prompt, cancel).await
     }
 
     /// Explain code using Claude
-    pub async fn explain_code(&self, code: &str) -> Result<String, Box<dyn std::error::Error>> {
-        let prompt = format!(
-            "Explain the following Visual Basic 6 code in a concise way:\n\n{}",
-            code
-        );
+    pub async fn explain_code(
+        &self,
+        code: &str,
+        cancel: Option<&CancelToken>,
+    ) -> Result<String, Box<dyn std::error::Error>> {
+        let prompt = explain_code_prompt(code);
+        self.cached_message("explain", &prompt, cancel).await
+    }
 
-        self.send_message(&prompt).await
+    /// Explain code, streaming the answer as it generates. `on_delta` is
+    /// called with each text fragment so the client can render partial
+    /// output; the return value is the assembled full text, which also
+    /// lands in the response cache for later identical asks.
+    pub async fn explain_code_streaming(
+        &self,
+        code: &str,
+        cancel: Option<&CancelToken>,
+        on_delta: impl FnMut(&str),
+    ) -> Result<String, Box<dyn std::error::Error>> {
+        let prompt = explain_code_prompt(code);
+        let key = ("explain", prompt_hash(&prompt));
+
+        // A cached answer still streams to the caller, in one piece
+        if let Some(hit) = self.cache.lock().unwrap().get(&key) {
+            let mut on_delta = on_delta;
+            on_delta(&hit);
+            return Ok(hit);
+        }
+
+        let text = self.stream_message(&prompt, cancel, on_delta).await?;
+        self.cache.lock().unwrap().insert(key, text.clone());
+        Ok(text)
     }
 
     /// Suggest refactoring using Claude
     pub async fn suggest_refactoring(
         &self,
         code: &str,
+        cancel: Option<&CancelToken>,
     ) -> Result<String, Box<dyn std::error::Error>> {
         let prompt = format!(
             "Suggest improvements or refactorings for this Visual Basic 6 code. Be specific and practical:\n\n{}",
             code
         );
 
-        self.send_message(&prompt).await
+        self.cached_message("refactor", &prompt, cancel).await
     }
 
     /// Explain an error using Claude
@@ -62,26 +152,28 @@ impl ClaudeClient {
         &self,
         error_message: &str,
         code_context: &str,
+        cancel: Option<&CancelToken>,
     ) -> Result<String, Box<dyn std::error::Error>> {
         let prompt = format!(
             "Explain this VB6 error and how to fix it:\n\nError: {}\n\nCode context:\n{}",
             error_message, code_context
         );
 
-        self.send_message(&prompt).await
+        self.cached_message("explain_error", &prompt, cancel).await
     }
 
     /// Generate documentation using Claude
     pub async fn generate_documentation(
         &self,
         code: &str,
+        cancel: Option<&CancelToken>,
     ) -> Result<String, Box<dyn std::error::Error>> {
         let prompt = format!(
             "Generate concise documentation comments for this Visual Basic 6 code:\n\n{}",
             code
         );
 
-        self.send_message(&prompt).await
+        self.cached_message("document", &prompt, cancel).await
     }
 
     /// Suggest migration to VB.NET/C# using Claude
@@ -89,27 +181,121 @@ impl ClaudeClient {
         &self,
         code: &str,
         target_language: &str,
+        cancel: Option<&CancelToken>,
     ) -> Result<String, Box<dyn std::error::Error>> {
         let prompt = format!(
             "Convert this Visual Basic 6 code to {}. Explain any important changes:\n\n{}",
             target_language, code
         );
 
-        self.send_message(&prompt).await
+        self.cached_message("migrate", &prompt, cancel).await
+    }
+
+    /// Serve a message from the cache, join an identical in-flight call,
+    /// or become the leader that actually talks to the API.
+    ///
+    /// Followers inherit the leader's outcome, including a cancellation
+    /// error if the leader's token fires — they are repeat asks of the
+    /// same content, so a retry will simply elect a new leader.
+    async fn cached_message(
+        &self,
+        operation: &'static str,
+        prompt: &str,
+        cancel: Option<&CancelToken>,
+    ) -> Result<String, Box<dyn std::error::Error>> {
+        let key = (operation, prompt_hash(prompt));
+
+        if let Some(hit) = self.cache.lock().unwrap().get(&key) {
+            return Ok(hit);
+        }
+
+        // Subscribe under the lock so the leader cannot publish between
+        // our map lookup and our subscription
+        let leader_tx = {
+            let mut in_flight = self.in_flight.lock().await;
+            match in_flight.get(&key) {
+                Some(tx) => {
+                    let mut rx = tx.subscribe();
+                    drop(in_flight);
+                    return rx.recv().await?.map_err(Into::into);
+                }
+                None => {
+                    let (tx, _rx) = broadcast::channel(1);
+                    in_flight.insert(key, tx.clone());
+                    tx
+                }
+            }
+        };
+
+        let result = self.send_message(prompt, cancel).await;
+
+        if let Ok(ref text) = result {
+            self.cache.lock().unwrap().insert(key, text.clone());
+        }
+
+        // Unregister before publishing: late arrivals either see the
+        // cache entry or start a fresh call, never a closed channel
+        self.in_flight.lock().await.remove(&key);
+        let _ = leader_tx.send(result.as_ref().map(Clone::clone).map_err(|e| e.to_string()));
+
+        result
     }
 
     /// Send a message to Claude API
-    async fn send_message(&self, prompt: &str) -> Result<String, Box<dyn std::error::Error>> {
-        let request = ClaudeRequest {
-            model: self.model.clone(),
-            max_tokens: 1024,
-            messages: vec![Message {
-                role: "user".to_string(),
-                content: prompt.to_string(),
-            }],
+    async fn send_message(
+        &self,
+        prompt: &str,
+        cancel: Option<&CancelToken>,
+    ) -> Result<String, Box<dyn std::error::Error>> {
+        let request = self.build_request(prompt, false);
+
+        let send = async {
+            let response = self
+                .client
+                .post("https://api.anthropic.com/v1/messages")
+                .header("x-api-key", &self.api_key)
+                .header("anthropic-version", "2023-06-01")
+                .header("content-type", "application/json")
+                .json(&request)
+                .send()
+                .await?;
+
+            if !response.status().is_success() {
+                let error_text = response.text().await?;
+                return Err(format!("Claude API error: {}", error_text).into());
+            }
+
+            let claude_response: ClaudeResponse = response.json().await?;
+
+            // Extract text from first content block
+            if let Some(content) = claude_response.content.first() {
+                Ok(content.text.clone())
+            } else {
+                Err("No response from Claude".into())
+            }
         };
 
-        let response = self
+        match cancel {
+            // Dropping the send future aborts the underlying transfer
+            Some(token) => tokio::select! {
+                result = send => result,
+                _ = token.cancelled() => Err("Request cancelled".into()),
+            },
+            None => send.await,
+        }
+    }
+
+    /// Send a message with `stream: true`, decoding the SSE event stream
+    /// chunk by chunk and handing each text delta to `on_delta`
+    async fn stream_message(
+        &self,
+        prompt: &str,
+        cancel: Option<&CancelToken>,
+        mut on_delta: impl FnMut(&str),
+    ) -> Result<String, Box<dyn std::error::Error>> {
+        let request = self.build_request(prompt, true);
+
+        let mut response = self
             .client
             .post("https://api.anthropic.com/v1/messages")
             .header("x-api-key", &self.api_key)
@@ -124,21 +310,129 @@ impl ClaudeClient {
             return Err(format!("Claude API error: {}", error_text).into());
         }
 
-        let claude_response: ClaudeResponse = response.json().await?;
+        let mut full_text = String::new();
+        // SSE lines can straddle chunk boundaries; carry the tail over
+        let mut pending = String::new();
 
-        // Extract text from first content block
-        if let Some(content) = claude_response.content.first() {
-            Ok(content.text.clone())
-        } else {
-            Err("No response from Claude".into())
+        loop {
+            let chunk = match cancel {
+                Some(token) => tokio::select! {
+                    chunk = response.chunk() => chunk?,
+                    _ = token.cancelled() => return Err("Request cancelled".into()),
+                },
+                None => response.chunk().await?,
+            };
+            let Some(bytes) = chunk else {
+                break;
+            };
+
+            pending.push_str(&String::from_utf8_lossy(&bytes));
+            while let Some(newline) = pending.find('\n') {
+                let line: String = pending.drain(..=newline).collect();
+                if let Some(delta) = sse_text_delta(line.trim_end()) {
+                    on_delta(&delta);
+                    full_text.push_str(&delta);
+                }
+            }
+        }
+
+        Ok(full_text)
+    }
+
+    fn build_request(&self, prompt: &str, stream: bool) -> ClaudeRequest {
+        ClaudeRequest {
+            model: self.model.clone(),
+            max_tokens: 1024,
+            stream,
+            messages: vec![Message {
+                role: "user".to_string(),
+                content: prompt.to_string(),
+            }],
         }
     }
 }
 
+fn explain_code_prompt(code: &str) -> String {
+    format!(
+        "Explain the following Visual Basic 6 code in a concise way:\n\n{}",
+        code
+    )
+}
+
+/// Extract the text delta from one SSE line, if it carries one
+fn sse_text_delta(line: &str) -> Option<String> {
+    let data = line.strip_prefix("data: ")?;
+    let event: StreamEvent = serde_json::from_str(data).ok()?;
+    if event.event_type != "content_block_delta" {
+        return None;
+    }
+    event.delta?.text
+}
+
+/// FNV-1a hash of a prompt, same scheme as the symbol cache keys
+fn prompt_hash(prompt: &str) -> u64 {
+    let mut hash: u64 = 0xcbf29ce484222325;
+    for byte in prompt.as_bytes() {
+        hash ^= u64::from(*byte);
+        hash = hash.wrapping_mul(0x100000001b3);
+    }
+    hash
+}
+
+/// Small LRU over completed responses: a map plus a logical clock, with
+/// the least-recently-served entry evicted when capacity is reached
+struct ResponseCache {
+    entries: HashMap<CacheKey, CacheEntry>,
+    clock: u64,
+}
+
+struct CacheEntry {
+    text: String,
+    last_used: u64,
+}
+
+impl ResponseCache {
+    fn new() -> Self {
+        Self {
+            entries: HashMap::new(),
+            clock: 0,
+        }
+    }
+
+    fn get(&mut self, key: &CacheKey) -> Option<String> {
+        self.clock += 1;
+        let entry = self.entries.get_mut(key)?;
+        entry.last_used = self.clock;
+        Some(entry.text.clone())
+    }
+
+    fn insert(&mut self, key: CacheKey, text: String) {
+        self.clock += 1;
+        if self.entries.len() >= CACHE_CAPACITY && !self.entries.contains_key(&key) {
+            if let Some(oldest) = self
+                .entries
+                .iter()
+                .min_by_key(|(_, e)| e.last_used)
+                .map(|(k, _)| *k)
+            {
+                self.entries.remove(&oldest);
+            }
+        }
+        self.entries.insert(
+            key,
+            CacheEntry {
+                text,
+                last_used: self.clock,
+            },
+        );
+    }
+}
+
 #[derive(Debug, Serialize)]
 struct ClaudeRequest {
     model: String,
     max_tokens: u32,
+    stream: bool,
     messages: Vec<Message>,
 }
 
@@ -158,6 +452,22 @@ struct ContentBlock {
     text: String,
 }
 
+/// One event from the SSE response stream; only the text deltas matter,
+/// everything else (message_start, ping, ...) is skipped
+#[derive(Debug, Deserialize)]
+struct StreamEvent {
+    #[serde(rename = "type")]
+    event_type: String,
+    #[serde(default)]
+    delta: Option<StreamDelta>,
+}
+
+#[derive(Debug, Deserialize)]
+struct StreamDelta {
+    #[serde(default)]
+    text: Option<String>,
+}
+
 /// Utility to get code context around a position
 pub fn get_code_context(full_text: &str, line: usize, character: usize, context_lines: usize) -> String {
     let lines: Vec<&str> = full_text.lines().collect();
@@ -178,3 +488,64 @@ pub fn get_code_context(full_text: &str, line: usize, character: usize, context_
 
     context
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_cache_evicts_least_recently_used() {
+        let mut cache = ResponseCache::new();
+        for i in 0..CACHE_CAPACITY as u64 {
+            cache.insert(("op", i), format!("response {}", i));
+        }
+
+        // Touch the oldest entry so entry 1 becomes the LRU victim
+        assert!(cache.get(&("op", 0)).is_some());
+        cache.insert(("op", CACHE_CAPACITY as u64), "overflow".to_string());
+
+        assert!(cache.get(&("op", 0)).is_some());
+        assert!(cache.get(&("op", 1)).is_none());
+        assert!(cache.get(&("op", CACHE_CAPACITY as u64)).is_some());
+    }
+
+    #[test]
+    fn test_cache_key_separates_operations() {
+        let hash = prompt_hash("Sub Main()");
+        let mut cache = ResponseCache::new();
+        cache.insert(("explain", hash), "an explanation".to_string());
+
+        assert!(cache.get(&("explain", hash)).is_some());
+        assert!(cache.get(&("refactor", hash)).is_none());
+    }
+
+    #[test]
+    fn test_sse_text_delta() {
+        let delta = sse_text_delta(
+            r#"data: {"type":"content_block_delta","index":0,"delta":{"type":"text_delta","text":"Hello"}}"#,
+        );
+        assert_eq!(delta.as_deref(), Some("Hello"));
+
+        // Non-delta events and non-data lines are skipped
+        assert!(sse_text_delta(r#"data: {"type":"message_start"}"#).is_none());
+        assert!(sse_text_delta("event: content_block_delta").is_none());
+        assert!(sse_text_delta("").is_none());
+    }
+
+    #[tokio::test]
+    async fn test_cancel_token_wakes_waiters() {
+        let token = CancelToken::new();
+        assert!(!token.is_cancelled());
+
+        let waiter = {
+            let token = token.clone();
+            tokio::spawn(async move { token.cancelled().await })
+        };
+        token.cancel();
+
+        assert!(token.is_cancelled());
+        waiter.await.unwrap();
+        // Cancellation is sticky: a late waiter returns immediately
+        token.cancelled().await;
+    }
+}
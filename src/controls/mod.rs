@@ -675,86 +675,88 @@ pub static MENU_DEF: ControlDef = ControlDef {
 // Control Registry
 // =============================================================================
 
-/// All control definitions indexed by type name
-static CONTROL_REGISTRY: Lazy<HashMap<&'static str, &'static ControlDef>> = Lazy::new(|| {
-    let mut map = HashMap::new();
+/// All control definitions indexed by case-folded type name. VB6 is
+/// case-insensitive and caller casing rarely matches, so keys are
+/// lowercased once here and every lookup is a single probe.
+static CONTROL_REGISTRY: Lazy<HashMap<String, &'static ControlDef>> = Lazy::new(|| {
+    let mut map: HashMap<String, &'static ControlDef> = HashMap::new();
+    let mut insert = |name: &str, def: &'static ControlDef| {
+        map.insert(name.to_ascii_lowercase(), def);
+    };
 
     // Standard controls
-    map.insert("Form", &FORM_DEF);
-    map.insert("MDIForm", &MDIFORM_DEF);
-    map.insert("TextBox", &TEXTBOX_DEF);
-    map.insert("Label", &LABEL_DEF);
-    map.insert("CommandButton", &COMMANDBUTTON_DEF);
-    map.insert("CheckBox", &CHECKBOX_DEF);
-    map.insert("OptionButton", &OPTIONBUTTON_DEF);
-    map.insert("Frame", &FRAME_DEF);
-    map.insert("ListBox", &LISTBOX_DEF);
-    map.insert("ComboBox", &COMBOBOX_DEF);
-    map.insert("PictureBox", &PICTUREBOX_DEF);
-    map.insert("Image", &IMAGE_DEF);
-    map.insert("Timer", &TIMER_DEF);
-    map.insert("HScrollBar", &HSCROLLBAR_DEF);
-    map.insert("VScrollBar", &VSCROLLBAR_DEF);
-    map.insert("Shape", &SHAPE_DEF);
-    map.insert("Line", &LINE_DEF);
-    map.insert("Data", &DATA_DEF);
-    map.insert("OLE", &OLE_DEF);
-    map.insert("FileListBox", &FILELISTBOX_DEF);
-    map.insert("DirListBox", &DIRLISTBOX_DEF);
-    map.insert("DriveListBox", &DRIVELISTBOX_DEF);
-    map.insert("Menu", &MENU_DEF);
+    insert("Form", &FORM_DEF);
+    insert("MDIForm", &MDIFORM_DEF);
+    insert("TextBox", &TEXTBOX_DEF);
+    insert("Label", &LABEL_DEF);
+    insert("CommandButton", &COMMANDBUTTON_DEF);
+    insert("CheckBox", &CHECKBOX_DEF);
+    insert("OptionButton", &OPTIONBUTTON_DEF);
+    insert("Frame", &FRAME_DEF);
+    insert("ListBox", &LISTBOX_DEF);
+    insert("ComboBox", &COMBOBOX_DEF);
+    insert("PictureBox", &PICTUREBOX_DEF);
+    insert("Image", &IMAGE_DEF);
+    insert("Timer", &TIMER_DEF);
+    insert("HScrollBar", &HSCROLLBAR_DEF);
+    insert("VScrollBar", &VSCROLLBAR_DEF);
+    insert("Shape", &SHAPE_DEF);
+    insert("Line", &LINE_DEF);
+    insert("Data", &DATA_DEF);
+    insert("OLE", &OLE_DEF);
+    insert("FileListBox", &FILELISTBOX_DEF);
+    insert("DirListBox", &DIRLISTBOX_DEF);
+    insert("DriveListBox", &DRIVELISTBOX_DEF);
+    insert("Menu", &MENU_DEF);
 
     map
 });
 
 /// Get a control definition by type name (case-insensitive)
 pub fn get_control(type_name: &str) -> Option<&'static ControlDef> {
-    // Try exact match first
-    if let Some(def) = CONTROL_REGISTRY.get(type_name) {
-        return Some(def);
-    }
-
-    // Case-insensitive search
-    let type_lower = type_name.to_lowercase();
-    for (name, def) in CONTROL_REGISTRY.iter() {
-        if name.to_lowercase() == type_lower {
-            return Some(def);
-        }
-    }
-
-    None
+    // Fold the query on the stack — control type names are short ASCII,
+    // so the common case is a single probe with no allocation
+    let mut buf = [0u8; 32];
+    let folded: &str = if type_name.len() <= buf.len() && type_name.is_ascii() {
+        let buf = &mut buf[..type_name.len()];
+        buf.copy_from_slice(type_name.as_bytes());
+        buf.make_ascii_lowercase();
+        std::str::from_utf8(buf).expect("ASCII stays valid UTF-8")
+    } else {
+        return CONTROL_REGISTRY.get(&type_name.to_lowercase()).copied();
+    };
+
+    CONTROL_REGISTRY.get(folded).copied()
 }
 
 /// Get all available control names
 pub fn get_control_names() -> Vec<&'static str> {
-    CONTROL_REGISTRY.keys().copied().collect()
+    CONTROL_REGISTRY.values().map(|def| def.name).collect()
 }
 
 /// Get property definition for a control
 pub fn get_property(control_type: &str, property_name: &str) -> Option<&'static PropertyDef> {
     let control = get_control(control_type)?;
-    let prop_lower = property_name.to_lowercase();
 
+    // Member slices are small; an allocation-free scan beats hashing
     control.properties.iter()
-        .find(|p| p.name.to_lowercase() == prop_lower)
+        .find(|p| p.name.eq_ignore_ascii_case(property_name))
 }
 
 /// Get event definition for a control
 pub fn get_event(control_type: &str, event_name: &str) -> Option<&'static EventDef> {
     let control = get_control(control_type)?;
-    let event_lower = event_name.to_lowercase();
 
     control.events.iter()
-        .find(|e| e.name.to_lowercase() == event_lower)
+        .find(|e| e.name.eq_ignore_ascii_case(event_name))
 }
 
 /// Get method definition for a control
 pub fn get_method(control_type: &str, method_name: &str) -> Option<&'static MethodDef> {
     let control = get_control(control_type)?;
-    let method_lower = method_name.to_lowercase();
 
     control.methods.iter()
-        .find(|m| m.name.to_lowercase() == method_lower)
+        .find(|m| m.name.eq_ignore_ascii_case(method_name))
 }
 
 /// Get all property names for a control type
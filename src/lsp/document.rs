@@ -1,60 +1,110 @@
 //! Document Management Utilities
 //!
-//! Helper functions for working with LSP documents.
+//! Helper functions for working with LSP documents, including the
+//! position mapper that converts between LSP UTF-16 columns, char
+//! offsets, and byte offsets.
 
 use ropey::Rope;
 use tower_lsp::lsp_types::Position;
 
-/// Convert LSP Position to byte offset in a Rope
-pub fn position_to_offset(rope: &Rope, position: Position) -> Option<usize> {
-    let line = position.line as usize;
-    if line >= rope.len_lines() {
-        return None;
+/// Position mapper over a document rope.
+///
+/// LSP `Position.character` counts UTF-16 code units, while tree-sitter
+/// wants byte offsets and the rope indexes chars; this type converts
+/// between all three. It borrows the rope's coordinate tree, which is
+/// updated incrementally on every edit, so each conversion is O(log
+/// lines) with no separately maintained index to rebuild.
+pub struct LineIndex<'a> {
+    rope: &'a Rope,
+}
+
+impl<'a> LineIndex<'a> {
+    pub fn new(rope: &'a Rope) -> Self {
+        Self { rope }
     }
 
-    let line_start = rope.line_to_char(line);
-    let offset = line_start + position.character as usize;
+    /// Convert an LSP position to a char offset. Columns past the end
+    /// of the line clamp to the line end, matching client behavior for
+    /// positions left dangling by concurrent edits.
+    pub fn position_to_char(&self, position: Position) -> Option<usize> {
+        let line = position.line as usize;
+        if line >= self.rope.len_lines() {
+            return None;
+        }
 
-    if offset > rope.len_chars() {
-        None
-    } else {
-        Some(offset)
+        let line_start_char = self.rope.line_to_char(line);
+        let line_start_u16 = self.rope.char_to_utf16_cu(line_start_char);
+        let line_end_char = if line + 1 < self.rope.len_lines() {
+            self.rope.line_to_char(line + 1)
+        } else {
+            self.rope.len_chars()
+        };
+        let line_end_u16 = self.rope.char_to_utf16_cu(line_end_char);
+
+        let target = (line_start_u16 + position.character as usize).min(line_end_u16);
+        Some(self.rope.utf16_cu_to_char(target))
     }
-}
 
-/// Convert byte offset to LSP Position in a Rope
-pub fn offset_to_position(rope: &Rope, offset: usize) -> Position {
-    let line = rope.char_to_line(offset);
-    let line_start = rope.line_to_char(line);
-    let character = offset - line_start;
+    /// Convert an LSP position to a byte offset
+    pub fn position_to_byte(&self, position: Position) -> Option<usize> {
+        self.position_to_char(position)
+            .map(|c| self.rope.char_to_byte(c))
+    }
 
-    Position {
-        line: line as u32,
-        character: character as u32,
+    /// Convert a char offset to an LSP position
+    pub fn char_to_position(&self, char_idx: usize) -> Position {
+        let char_idx = char_idx.min(self.rope.len_chars());
+        let line = self.rope.char_to_line(char_idx);
+        let line_start_char = self.rope.line_to_char(line);
+
+        let line_start_u16 = self.rope.char_to_utf16_cu(line_start_char);
+        let u16_offset = self.rope.char_to_utf16_cu(char_idx);
+
+        Position {
+            line: line as u32,
+            character: (u16_offset - line_start_u16) as u32,
+        }
+    }
+
+    /// Convert a byte offset to an LSP position
+    pub fn byte_to_position(&self, byte_idx: usize) -> Position {
+        let byte_idx = byte_idx.min(self.rope.len_bytes());
+        self.char_to_position(self.rope.byte_to_char(byte_idx))
     }
 }
 
+/// Convert LSP Position to a char offset in a Rope (UTF-16 correct)
+pub fn position_to_offset(rope: &Rope, position: Position) -> Option<usize> {
+    LineIndex::new(rope).position_to_char(position)
+}
+
+/// Convert a char offset to an LSP Position in a Rope (UTF-16 correct)
+pub fn offset_to_position(rope: &Rope, offset: usize) -> Position {
+    LineIndex::new(rope).char_to_position(offset)
+}
+
 /// Get the word at a given position
 pub fn word_at_position(rope: &Rope, position: Position) -> Option<String> {
     let offset = position_to_offset(rope, position)?;
     let line = position.line as usize;
 
-    if line >= rope.len_lines() {
-        return None;
-    }
-
     let line_text = rope.line(line).to_string();
-    let char_offset = position.character as usize;
+    let char_offset = offset - rope.line_to_char(line);
+    let byte_offset = line_text
+        .char_indices()
+        .nth(char_offset)
+        .map(|(b, _)| b)
+        .unwrap_or(line_text.len());
 
     // Find word boundaries
-    let start = line_text[..char_offset]
+    let start = line_text[..byte_offset]
         .rfind(|c: char| !c.is_alphanumeric() && c != '_')
         .map(|i| i + 1)
         .unwrap_or(0);
 
-    let end = line_text[char_offset..]
+    let end = line_text[byte_offset..]
         .find(|c: char| !c.is_alphanumeric() && c != '_')
-        .map(|i| char_offset + i)
+        .map(|i| byte_offset + i)
         .unwrap_or(line_text.len());
 
     if start < end {
@@ -63,3 +113,61 @@ pub fn word_at_position(rope: &Rope, position: Position) -> Option<String> {
         None
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_utf16_positions_with_non_bmp_text() {
+        // The emoji is one char but two UTF-16 code units
+        let rope = Rope::from_str("ab😀cd\nnext\n");
+        let index = LineIndex::new(&rope);
+
+        // 'c' sits after the surrogate pair: UTF-16 column 4, char 3
+        let c_char = index
+            .position_to_char(Position { line: 0, character: 4 })
+            .unwrap();
+        assert_eq!(rope.char(c_char), 'c');
+
+        // Round trip back to UTF-16 columns
+        let pos = index.char_to_position(c_char);
+        assert_eq!(pos, Position { line: 0, character: 4 });
+    }
+
+    #[test]
+    fn test_byte_conversions() {
+        let rope = Rope::from_str("Dim caf\u{e9} As String\n");
+        let index = LineIndex::new(&rope);
+
+        // 'é' is two bytes; the byte offset of " As" reflects that
+        let byte = index
+            .position_to_byte(Position { line: 0, character: 8 })
+            .unwrap();
+        assert_eq!(&rope.to_string()[byte..byte + 3], " As");
+        assert_eq!(
+            index.byte_to_position(byte),
+            Position { line: 0, character: 8 }
+        );
+    }
+
+    #[test]
+    fn test_column_clamps_to_line_end() {
+        let rope = Rope::from_str("short\nlonger line\n");
+        let index = LineIndex::new(&rope);
+
+        let idx = index
+            .position_to_char(Position { line: 0, character: 99 })
+            .unwrap();
+        // Clamped to the line end (including its newline), not into line 1
+        assert!(idx <= rope.line_to_char(1));
+        assert!(index.position_to_char(Position { line: 9, character: 0 }).is_none());
+    }
+
+    #[test]
+    fn test_word_at_position() {
+        let rope = Rope::from_str("Dim orderCount As Integer\n");
+        let word = word_at_position(&rope, Position { line: 0, character: 6 });
+        assert_eq!(word.as_deref(), Some("orderCount"));
+    }
+}
@@ -0,0 +1,268 @@
+//! Memory Budget and Eviction
+//!
+//! Every open document keeps a rope, a tree-sitter tree, the converted
+//! AST and a symbol table alive; over a long session across a large
+//! workspace that adds up. This module tracks a rough per-component byte
+//! estimate and, when the total passes a configurable budget, evicts the
+//! recoverable parts (tree, AST, the parser's cached tree) of the
+//! least-recently-touched documents. The rope and the compact symbol
+//! table stay resident, so navigation keeps working; the next edit or
+//! analysis of an evicted document simply pays one full reparse.
+
+use std::sync::atomic::{AtomicU64, Ordering};
+
+use dashmap::DashMap;
+use once_cell::sync::Lazy;
+use tower_lsp::lsp_types::Url;
+
+use crate::parser::Vb6Ast;
+
+use super::Document;
+
+/// Environment variable overriding the memory budget, in megabytes
+const BUDGET_ENV: &str = "VB6_LSP_MEMORY_BUDGET_MB";
+
+/// Budget applied when the environment variable is absent or unparsable
+const DEFAULT_BUDGET_BYTES: u64 = 512 * 1024 * 1024;
+
+/// Logical clock for LRU ordering; bumped on every document touch.
+/// A counter rather than wall time so ordering is total and cheap.
+static CLOCK: AtomicU64 = AtomicU64::new(1);
+
+/// The configured budget in bytes (read from the environment once)
+pub fn budget_bytes() -> u64 {
+    static BUDGET: Lazy<u64> = Lazy::new(|| {
+        std::env::var(BUDGET_ENV)
+            .ok()
+            .and_then(|v| v.parse::<u64>().ok())
+            .map(|mb| mb * 1024 * 1024)
+            .unwrap_or(DEFAULT_BUDGET_BYTES)
+    });
+    *BUDGET
+}
+
+/// Next value of the LRU clock, for initializing a new document
+pub fn tick() -> u64 {
+    CLOCK.fetch_add(1, Ordering::Relaxed)
+}
+
+/// Mark a document as recently used, protecting it from eviction
+pub fn touch(doc: &Document) {
+    doc.last_touched.store(tick(), Ordering::Relaxed);
+}
+
+/// Estimated footprint of one document, per component. These are
+/// estimates, not allocator measurements: the tree size is extrapolated
+/// from the source size and the AST from node counts, which is accurate
+/// enough to drive eviction and to show where the bytes go.
+#[derive(Debug, serde::Serialize)]
+pub struct DocumentMemory {
+    pub uri: String,
+    pub content_bytes: u64,
+    pub tree_bytes: u64,
+    pub ast_bytes: u64,
+    pub symbol_table_bytes: u64,
+    /// False once the tree and AST have been evicted
+    pub resident: bool,
+}
+
+impl DocumentMemory {
+    pub fn total_bytes(&self) -> u64 {
+        self.content_bytes + self.tree_bytes + self.ast_bytes + self.symbol_table_bytes
+    }
+}
+
+/// Estimate the footprint of a document
+pub fn estimate(uri: &Url, doc: &Document) -> DocumentMemory {
+    let content_bytes = doc.content.len_bytes() as u64;
+
+    // Tree-sitter does not report its allocation size; node records
+    // dominate and scale with the source, observed at roughly 8x for
+    // this grammar. The parser caches a second copy of the tree for
+    // incremental reparsing, hence the factor of two.
+    let tree_bytes = if doc.tree.is_some() {
+        content_bytes * 8 * 2
+    } else {
+        0
+    };
+
+    let ast_bytes = doc.ast.get().map_or(0, ast_bytes);
+
+    let symbol_table_bytes = doc
+        .symbol_table
+        .as_ref()
+        .map_or(0, |table| table.approx_bytes());
+
+    DocumentMemory {
+        uri: uri.to_string(),
+        content_bytes,
+        tree_bytes,
+        ast_bytes,
+        symbol_table_bytes,
+        resident: doc.tree.is_some(),
+    }
+}
+
+/// Rough AST footprint: fixed node sizes plus a flat allowance for the
+/// strings each node owns
+fn ast_bytes(ast: &Vb6Ast) -> u64 {
+    use std::mem::size_of;
+
+    const STRING_ALLOWANCE: usize = 48;
+
+    let nodes = ast.procedures.len() * size_of::<crate::parser::Procedure>()
+        + ast.variables.len() * size_of::<crate::parser::Variable>()
+        + ast.constants.len() * size_of::<crate::parser::Constant>()
+        + ast.user_types.len() * size_of::<crate::parser::UserType>()
+        + ast.enums.len() * size_of::<crate::parser::Enumeration>();
+
+    let node_count = ast.procedures.len()
+        + ast.variables.len()
+        + ast.constants.len()
+        + ast.user_types.len()
+        + ast.enums.len()
+        + ast.comments.len()
+        + ast.statements.len();
+
+    (nodes + node_count * STRING_ALLOWANCE) as u64
+}
+
+/// Drop the recoverable state of documents, oldest first, until the
+/// estimated total fits the budget. Called after each analysis stores
+/// its results — the moment the total can grow.
+pub fn enforce_budget(documents: &DashMap<Url, Document>) {
+    enforce(documents, budget_bytes());
+}
+
+fn enforce(documents: &DashMap<Url, Document>, budget: u64) {
+    let mut total: u64 = 0;
+    // (uri, last touched, bytes freed by evicting) for resident documents
+    let mut candidates: Vec<(Url, u64, u64)> = Vec::new();
+
+    for entry in documents.iter() {
+        let usage = estimate(entry.key(), entry.value());
+        total += usage.total_bytes();
+        if usage.resident {
+            candidates.push((
+                entry.key().clone(),
+                entry.value().last_touched.load(Ordering::Relaxed),
+                usage.tree_bytes + usage.ast_bytes,
+            ));
+        }
+    }
+
+    if total <= budget {
+        return;
+    }
+
+    candidates.sort_by_key(|&(_, touched, _)| touched);
+
+    for (uri, _, recoverable) in candidates {
+        if total <= budget {
+            break;
+        }
+        if let Some(mut doc) = documents.get_mut(&uri) {
+            evict(&mut doc);
+            total = total.saturating_sub(recoverable);
+            tracing::debug!(
+                "Evicted parse state for {} ({} bytes over budget)",
+                uri,
+                total.saturating_sub(budget)
+            );
+        }
+    }
+}
+
+/// Drop the state a reparse can rebuild: the tree, the converted AST,
+/// the parser's cached tree, and the now-meaningless pending edits.
+/// The symbol table survives so navigation stays precise.
+fn evict(doc: &mut Document) {
+    doc.tree = None;
+    doc.ast = once_cell::sync::OnceCell::new();
+    doc.pending_edits.clear();
+    doc.parser.lock().unwrap().clear_cache();
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::{Arc, Mutex};
+
+    use ropey::Rope;
+
+    use crate::parser::Vb6Parser;
+    use crate::utils::Encoding;
+
+    fn open_doc(source: &str) -> Document {
+        let mut parser = Vb6Parser::new();
+        let rope = Rope::from_str(source);
+        let tree = parser.parse_rope(&rope);
+        Document {
+            content: rope,
+            version: 1,
+            encoding: Encoding::Utf8,
+            parser: Arc::new(Mutex::new(parser)),
+            ast: once_cell::sync::OnceCell::new(),
+            tree,
+            pending_edits: Vec::new(),
+            symbol_table: None,
+            diagnostic_cache: Default::default(),
+            last_touched: tick().into(),
+        }
+    }
+
+    #[test]
+    fn test_estimate_distinguishes_resident_state() {
+        let uri = Url::parse("file:///mod.bas").unwrap();
+        let mut doc = open_doc("Sub A()\nEnd Sub\n");
+
+        let usage = estimate(&uri, &doc);
+        assert!(usage.resident);
+        assert!(usage.content_bytes > 0);
+        assert!(usage.tree_bytes > 0);
+
+        evict(&mut doc);
+        let usage = estimate(&uri, &doc);
+        assert!(!usage.resident);
+        assert_eq!(usage.tree_bytes, 0);
+        assert_eq!(usage.ast_bytes, 0);
+    }
+
+    #[test]
+    fn test_eviction_drops_oldest_first() {
+        let documents = DashMap::new();
+        let old_uri = Url::parse("file:///old.bas").unwrap();
+        let new_uri = Url::parse("file:///new.bas").unwrap();
+        documents.insert(old_uri.clone(), open_doc("Sub A()\nEnd Sub\n"));
+        documents.insert(new_uri.clone(), open_doc("Sub B()\nEnd Sub\n"));
+        touch(&documents.get(&new_uri).unwrap());
+
+        let total: u64 = documents
+            .iter()
+            .map(|e| estimate(e.key(), e.value()).total_bytes())
+            .sum();
+        let oldest_recoverable = {
+            let doc = documents.get(&old_uri).unwrap();
+            let usage = estimate(&old_uri, &doc);
+            usage.tree_bytes + usage.ast_bytes
+        };
+
+        // Budget that one eviction satisfies: only the stale document
+        // loses its parse state
+        enforce(&documents, total - oldest_recoverable);
+
+        assert!(documents.get(&old_uri).unwrap().tree.is_none());
+        assert!(documents.get(&new_uri).unwrap().tree.is_some());
+    }
+
+    #[test]
+    fn test_no_eviction_under_budget() {
+        let documents = DashMap::new();
+        let uri = Url::parse("file:///mod.bas").unwrap();
+        documents.insert(uri.clone(), open_doc("Sub A()\nEnd Sub\n"));
+
+        enforce(&documents, u64::MAX);
+
+        assert!(documents.get(&uri).unwrap().tree.is_some());
+    }
+}
@@ -5,8 +5,11 @@
 mod capabilities;
 mod document;
 mod handlers;
+mod memory;
+mod semantic_tokens;
 
-use std::sync::{Arc, RwLock};
+use std::sync::{Arc, Mutex, RwLock};
+use std::time::Duration;
 
 use dashmap::DashMap;
 use ropey::Rope;
@@ -14,9 +17,10 @@ use tower_lsp::jsonrpc::Result;
 use tower_lsp::lsp_types::*;
 use tower_lsp::{Client, LanguageServer};
 
-use crate::analysis::{build_symbol_table, Analyzer, SymbolTable};
+use crate::analysis::{build_symbol_table, update_symbol_table, Analyzer, SymbolTable};
 use crate::claude::ClaudeClient;
 use crate::parser::Vb6Parser;
+use crate::utils::perf;
 use crate::utils::Encoding;
 use crate::workspace::WorkspaceManager;
 
@@ -28,12 +32,45 @@ pub struct Document {
     pub version: i32,
     /// Detected encoding (UTF-8 or Windows-1252)
     pub encoding: Encoding,
-    /// Parsed AST (if available)
-    pub ast: Option<crate::parser::Vb6Ast>,
+    /// Per-document parser (owns the last tree for incremental parsing).
+    /// Each document has its own parser so edits in one file never
+    /// serialize parses of other files; the Arc lets compute-pool tasks
+    /// borrow it without holding the document entry.
+    pub parser: Arc<Mutex<Vb6Parser>>,
+    /// Lazily converted AST. The tree-sitter tree is the source of
+    /// truth; conversion runs at most once per analyzed version, on
+    /// first access, and the analysis task seeds it for free when it
+    /// needed the AST for diagnostics anyway.
+    ast: once_cell::sync::OnceCell<crate::parser::Vb6Ast>,
     /// Tree-sitter tree for incremental parsing
     pub tree: Option<tree_sitter::Tree>,
+    /// Edits applied since the last analysis (drives incremental
+    /// symbol table updates)
+    pub pending_edits: Vec<tree_sitter::InputEdit>,
     /// Symbol table (if available)
     pub symbol_table: Option<SymbolTable>,
+    /// Cached diagnostics from the last analysis; keystroke-time
+    /// analyses re-check only the procedures an edit touched and reuse
+    /// the rest from here
+    pub diagnostic_cache: crate::analysis::DiagnosticCache,
+    /// LRU clock value of the last interaction with this document;
+    /// the memory manager evicts parse state oldest-first
+    pub last_touched: std::sync::atomic::AtomicU64,
+}
+
+impl Document {
+    /// AST for the current tree, converting on first access.
+    ///
+    /// Handlers that only need the symbol table never pay for the
+    /// conversion; AST-fallback paths trigger it once and share the
+    /// result until the next analysis replaces the tree.
+    pub fn ast(&self) -> Option<&crate::parser::Vb6Ast> {
+        let tree = self.tree.as_ref()?;
+        Some(self.ast.get_or_init(|| {
+            let _t = perf::time("pipeline.convert");
+            Vb6Parser::ast_from_tree(tree, &self.content.to_string())
+        }))
+    }
 }
 
 impl std::fmt::Debug for Document {
@@ -41,7 +78,7 @@ impl std::fmt::Debug for Document {
         f.debug_struct("Document")
             .field("content", &self.content)
             .field("version", &self.version)
-            .field("ast", &self.ast)
+            .field("ast", &self.ast.get().map(|_| "..."))
             .field("tree", &self.tree.as_ref().map(|_| "..."))
             .field("symbol_table", &self.symbol_table.as_ref().map(|t| format!("{} symbols", t.symbol_count())))
             .finish()
@@ -52,16 +89,89 @@ impl std::fmt::Debug for Document {
 pub struct Vb6LanguageServer {
     /// LSP client for sending notifications
     client: Client,
-    /// Open documents
-    documents: DashMap<Url, Document>,
-    /// VB6 Parser (uses RwLock for incremental parsing support)
-    parser: Arc<RwLock<Vb6Parser>>,
+    /// Open documents (shared with background analysis tasks)
+    documents: Arc<DashMap<Url, Document>>,
     /// Code analyzer
     analyzer: Arc<Analyzer>,
     /// Claude AI client (optional)
     claude: Option<Arc<ClaudeClient>>,
     /// Workspace manager for multi-project support
     workspace: Arc<RwLock<WorkspaceManager>>,
+    /// Per-document diagnostics generation counters; a debounce timer
+    /// only runs its analysis if its generation is still the latest
+    pending_diagnostics: Arc<DashMap<Url, u64>>,
+    /// Last completion candidate pool per document; reused when the user
+    /// extends the typed prefix so refinement only re-ranks
+    completion_sessions: DashMap<Url, CompletionSession>,
+    /// Previous semantic token stream per document, keyed by the result
+    /// id handed to the client; lets delta requests send only the
+    /// changed token runs
+    semantic_token_results: DashMap<Url, (String, Vec<SemanticToken>)>,
+}
+
+/// Cached candidate pool from the previous completion request.
+///
+/// The pool stays valid while the document version, line, and prefix
+/// start column are unchanged and the new prefix extends the old one —
+/// in that case ranking the cached pool replaces a full symbol walk.
+struct CompletionSession {
+    version: i32,
+    line: u32,
+    prefix_start: u32,
+    prefix: String,
+    pool: Vec<CompletionItem>,
+}
+
+/// Response payload for the custom `vb6/memoryStats` request
+#[derive(Debug, serde::Serialize)]
+pub struct MemoryStatsResponse {
+    /// Configured budget (`VB6_LSP_MEMORY_BUDGET_MB` to override)
+    pub budget_bytes: u64,
+    /// Estimated total across all open documents
+    pub estimated_total_bytes: u64,
+    /// Documents whose tree and AST are currently evicted
+    pub evicted_documents: usize,
+    /// Per-document component estimates, largest first
+    pub documents: Vec<memory::DocumentMemory>,
+}
+
+/// Response payload for the custom `vb6/perfStats` request
+#[derive(Debug, serde::Serialize)]
+pub struct PerfStatsResponse {
+    /// Per-stage latency histograms (p50/p95/max, counts, bytes)
+    pub stages: Vec<perf::StageSnapshot>,
+    /// Workspace counters from `WorkspaceManager::stats`
+    pub workspace: crate::workspace::WorkspaceStats,
+    /// Documents currently open in the editor
+    pub open_documents: usize,
+}
+
+/// Extract the identifier prefix ending at the cursor, returning the
+/// prefix text and the column where it starts.
+fn typed_prefix(source: &str, position: Position) -> (String, u32) {
+    let line = source.lines().nth(position.line as usize).unwrap_or("");
+    let chars: Vec<char> = line.chars().collect();
+    let cursor = (position.character as usize).min(chars.len());
+
+    let mut start = cursor;
+    while start > 0 && (chars[start - 1].is_alphanumeric() || chars[start - 1] == '_') {
+        start -= 1;
+    }
+
+    (chars[start..cursor].iter().collect(), start as u32)
+}
+
+/// How long to wait after the last change before analyzing.
+/// Overridable via VB6_LSP_DEBOUNCE_MS for slow machines or tests.
+fn diagnostics_debounce() -> Duration {
+    static DEBOUNCE: once_cell::sync::Lazy<Duration> = once_cell::sync::Lazy::new(|| {
+        let ms = std::env::var("VB6_LSP_DEBOUNCE_MS")
+            .ok()
+            .and_then(|v| v.parse().ok())
+            .unwrap_or(200);
+        Duration::from_millis(ms)
+    });
+    *DEBOUNCE
 }
 
 impl Vb6LanguageServer {
@@ -79,11 +189,13 @@ impl Vb6LanguageServer {
 
         Self {
             client,
-            documents: DashMap::new(),
-            parser: Arc::new(RwLock::new(Vb6Parser::new())),
+            documents: Arc::new(DashMap::new()),
             analyzer: Arc::new(Analyzer::new()),
             claude,
             workspace: Arc::new(RwLock::new(WorkspaceManager::new())),
+            pending_diagnostics: Arc::new(DashMap::new()),
+            completion_sessions: DashMap::new(),
+            semantic_token_results: DashMap::new(),
         }
     }
 
@@ -92,94 +204,295 @@ impl Vb6LanguageServer {
         self.documents.get(uri)
     }
 
-    /// Parse a document and update diagnostics
-    async fn parse_and_diagnose(&self, uri: &Url) {
-        if let Some(mut doc) = self.documents.get_mut(uri) {
-            let content = doc.content.to_string();
-
-            // Parse the document using tree-sitter
-            let (parse_result, tree) = {
-                let mut parser = self.parser.write().unwrap();
-                let result = parser.parse(&content);
-                // Get the tree for symbol table building
-                let tree = parser.get_tree().cloned();
-                (result, tree)
+    /// Every reference to the symbol at `position`, across the whole
+    /// workspace: the local symbol table's resolved references plus the
+    /// parallel fan-out over other modules' tables. Shared by the
+    /// references and rename handlers.
+    fn reference_locations(
+        &self,
+        table: &SymbolTable,
+        content: &str,
+        uri: &Url,
+        position: Position,
+    ) -> Vec<Location> {
+        let mut locations = self.analyzer.get_references_with_symbols(table, position);
+
+        // Fan out across the workspace: the defining module is either
+        // this one (already covered by the local pass) or wherever the
+        // symbol index says the name is declared
+        if let (Some(word), Ok(current)) = (
+            self.get_word_at_position(content, position),
+            uri.to_file_path(),
+        ) {
+            let workspace = self.workspace.read().unwrap();
+            let local_definition = table.lookup_symbol(&word, table.module_scope).is_some();
+            let defining = if local_definition {
+                Some(current.clone())
+            } else {
+                workspace
+                    .resolve_symbol(&word, &current)
+                    .and_then(|loc| loc.uri.to_file_path().ok())
             };
 
-            match parse_result {
-                Ok(ast) => {
-                    // Get any parse errors for diagnostics
-                    let parse_errors = {
-                        let mut parser = self.parser.write().unwrap();
-                        parser.get_errors(&content)
-                    };
+            if let Some(defining) = defining {
+                let skip = local_definition.then_some(current.as_path());
+                locations.extend(workspace.find_references(&word, &defining, skip));
+            }
+        }
 
-                    // Run analysis
-                    let mut diagnostics = self.analyzer.analyze(&ast);
+        // The workspace copy of this document's table can overlap with
+        // the live one; keep each location once
+        let mut seen = std::collections::HashSet::new();
+        locations.retain(|loc| {
+            seen.insert((
+                loc.uri.clone(),
+                loc.range.start.line,
+                loc.range.start.character,
+                loc.range.end.line,
+                loc.range.end.character,
+            ))
+        });
+
+        locations
+    }
 
-                    // Add parse errors as diagnostics
-                    for error in parse_errors {
-                        diagnostics.push(Diagnostic {
-                            range: error.range,
-                            severity: Some(DiagnosticSeverity::ERROR),
-                            message: error.message,
-                            source: Some("vb6-lsp".to_string()),
-                            ..Default::default()
-                        });
-                    }
+    /// Handler for the custom `vb6/perfStats` request: a snapshot of the
+    /// per-stage latency histograms plus workspace counters, for fleet
+    /// monitoring. Registered in main.rs via `custom_method`.
+    pub async fn perf_stats(&self) -> Result<PerfStatsResponse> {
+        let workspace = self.workspace.read().unwrap().stats();
+        Ok(PerfStatsResponse {
+            stages: perf::snapshot(),
+            workspace,
+            open_documents: self.documents.len(),
+        })
+    }
 
-                    doc.ast = Some(ast);
-
-                    // Build symbol table from tree-sitter tree
-                    if let Some(ref ts_tree) = tree {
-                        let symbol_table = build_symbol_table(uri.clone(), &content, ts_tree);
-                        tracing::debug!(
-                            "Built symbol table with {} symbols, {} scopes",
-                            symbol_table.symbol_count(),
-                            symbol_table.scope_count()
-                        );
-
-                        // Register with workspace manager for cross-project navigation
-                        if let Ok(file_path) = uri.to_file_path() {
-                            let mut workspace = self.workspace.write().unwrap();
-                            // Clone the symbol table for workspace (document keeps its own copy)
-                            workspace.set_symbol_table(&file_path, symbol_table.clone());
-                        }
+    /// Handler for the custom `vb6/memoryStats` request: the configured
+    /// budget and per-document component estimates, largest first, for
+    /// tuning `VB6_LSP_MEMORY_BUDGET_MB`. Registered in main.rs via
+    /// `custom_method`.
+    pub async fn memory_stats(&self) -> Result<MemoryStatsResponse> {
+        let mut documents: Vec<memory::DocumentMemory> = self
+            .documents
+            .iter()
+            .map(|entry| memory::estimate(entry.key(), entry.value()))
+            .collect();
+        documents.sort_by_key(|d| std::cmp::Reverse(d.total_bytes()));
+
+        Ok(MemoryStatsResponse {
+            budget_bytes: memory::budget_bytes(),
+            estimated_total_bytes: documents.iter().map(|d| d.total_bytes()).sum(),
+            evicted_documents: documents.iter().filter(|d| !d.resident).count(),
+            documents,
+        })
+    }
 
-                        doc.symbol_table = Some(symbol_table);
-                    }
+    /// Parse a document and update diagnostics immediately. Used on open
+    /// and save, so this runs the full analysis including the module-wide
+    /// passes that keystroke-time analyses skip.
+    async fn parse_and_diagnose(&self, uri: &Url) {
+        Self::analyze_document(
+            &self.client,
+            &self.documents,
+            &self.analyzer,
+            &self.workspace,
+            uri,
+            true,
+        )
+        .await;
+    }
+
+    /// Schedule a debounced analysis for a document. Rapid successive
+    /// changes coalesce into one analysis: each call bumps the document's
+    /// generation counter and a timer fired for a superseded generation
+    /// simply does nothing.
+    fn schedule_diagnostics(&self, uri: Url) {
+        let generation = {
+            let mut entry = self.pending_diagnostics.entry(uri.clone()).or_insert(0);
+            *entry += 1;
+            *entry
+        };
+
+        let pending = Arc::clone(&self.pending_diagnostics);
+        let client = self.client.clone();
+        let documents = Arc::clone(&self.documents);
+        let analyzer = Arc::clone(&self.analyzer);
+        let workspace = Arc::clone(&self.workspace);
+
+        tokio::spawn(async move {
+            tokio::time::sleep(diagnostics_debounce()).await;
+
+            // A newer change arrived while we slept; let its timer run instead
+            if pending.get(&uri).map(|g| *g) != Some(generation) {
+                return;
+            }
+
+            Self::analyze_document(&client, &documents, &analyzer, &workspace, &uri, false).await;
+        });
+    }
+
+    /// Parse, analyze and publish diagnostics for a document. Diagnostics
+    /// are published tagged with the version that was analyzed, so clients
+    /// discard results that a newer edit has obsoleted.
+    ///
+    /// `full` selects between the full analysis (every check plus the
+    /// module-wide passes; open/save) and the incremental one that
+    /// re-checks only procedures intersecting the recorded edits.
+    async fn analyze_document(
+        client: &Client,
+        documents: &DashMap<Url, Document>,
+        analyzer: &Arc<Analyzer>,
+        workspace: &Arc<RwLock<WorkspaceManager>>,
+        uri: &Url,
+        full: bool,
+    ) {
+        // Snapshot the inputs under a short lock; the CPU-heavy stages run
+        // on the blocking pool so hover/completion stay responsive.
+        let Some((rope, version, parser, old_tree, edits, old_table, mut diag_cache)) =
+            documents.get_mut(uri).map(|mut doc| {
+                (
+                    doc.content.clone(),
+                    doc.version,
+                    Arc::clone(&doc.parser),
+                    doc.tree.take(),
+                    std::mem::take(&mut doc.pending_edits),
+                    doc.symbol_table.take(),
+                    std::mem::take(&mut doc.diagnostic_cache),
+                )
+            })
+        else {
+            return;
+        };
+
+        let task_uri = uri.clone();
+        let task_analyzer = Arc::clone(analyzer);
+        let result = tokio::task::spawn_blocking(move || {
+            let source_bytes = rope.len_bytes() as u64;
+
+            // Incremental parse reading rope chunks in place; did_change has
+            // already applied the edits to the cached tree, so only the
+            // affected region is reparsed.
+            let tree = {
+                let _t = perf::time_bytes("pipeline.parse", source_bytes);
+                parser.lock().unwrap().parse_rope(&rope)?
+            };
 
-                    // Publish diagnostics
-                    self.client
-                        .publish_diagnostics(uri.clone(), diagnostics, Some(doc.version))
-                        .await;
+            // AST conversion and symbol building still need contiguous text
+            let content = rope.to_string();
+            let (ast, parse_errors) = {
+                let _t = perf::time_bytes("pipeline.convert", source_bytes);
+                (
+                    Vb6Parser::ast_from_tree(&tree, &content),
+                    Vb6Parser::errors_from_tree(&tree, &content),
+                )
+            };
+
+            // Run analysis: incremental on keystrokes (only procedures
+            // intersecting the edits are re-checked, module-wide passes
+            // come from the cache), full on open/save
+            let _t = perf::time_bytes("pipeline.analyze", source_bytes);
+            let mut diagnostics = match &old_tree {
+                Some(old) if !full && !edits.is_empty() => {
+                    let changed: Vec<tree_sitter::Range> = old.changed_ranges(&tree).collect();
+                    task_analyzer.analyze_incremental(&ast, &edits, &changed, &mut diag_cache)
                 }
-                Err(errors) => {
-                    // Convert parse errors to diagnostics
-                    let diagnostics: Vec<Diagnostic> = errors
-                        .into_iter()
-                        .map(|e| Diagnostic {
-                            range: e.range,
-                            severity: Some(DiagnosticSeverity::ERROR),
-                            message: e.message,
-                            source: Some("vb6-lsp".to_string()),
-                            ..Default::default()
-                        })
-                        .collect();
+                _ => task_analyzer.analyze_full(&ast, &mut diag_cache),
+            };
+            drop(_t);
+
+            // Add parse errors as diagnostics
+            for error in parse_errors {
+                diagnostics.push(Diagnostic {
+                    range: error.range,
+                    severity: Some(DiagnosticSeverity::ERROR),
+                    message: error.message,
+                    source: Some("vb6-lsp".to_string()),
+                    ..Default::default()
+                });
+            }
 
-                    self.client
-                        .publish_diagnostics(uri.clone(), diagnostics, Some(doc.version))
-                        .await;
+            // Build or incrementally update the symbol table. The edited old
+            // tree plus the recorded edits let us re-visit only the touched
+            // procedures; everything else falls back to a full build.
+            let _t = perf::time_bytes("pipeline.build_symbol_table", source_bytes);
+            let symbol_table = match (old_tree, old_table) {
+                (Some(ref old), Some(table)) if !edits.is_empty() => {
+                    update_symbol_table(task_uri.clone(), &content, &tree, old, &edits, table)
                 }
+                _ => build_symbol_table(task_uri, &content, &tree),
+            };
+            drop(_t);
+
+            Some((tree, ast, symbol_table, diagnostics, diag_cache))
+        })
+        .await;
+
+        let Ok(result) = result else {
+            tracing::warn!("Analysis task for {} panicked", uri);
+            return;
+        };
+
+        let Some((tree, ast, symbol_table, diagnostics, diag_cache)) = result else {
+            let diagnostics = vec![Diagnostic {
+                range: Range::default(),
+                severity: Some(DiagnosticSeverity::ERROR),
+                message: "Failed to parse source".to_string(),
+                source: Some("vb6-lsp".to_string()),
+                ..Default::default()
+            }];
+            client
+                .publish_diagnostics(uri.clone(), diagnostics, Some(version))
+                .await;
+            return;
+        };
+
+        // Store the results only if no newer edit arrived while we were
+        // computing; a stale table would carry wrong positions, and the
+        // newer version has its own analysis scheduled.
+        {
+            let Some(mut doc) = documents.get_mut(uri) else {
+                return;
+            };
+            if doc.version != version {
+                return;
             }
+
+            tracing::debug!(
+                "Built symbol table with {} symbols, {} scopes",
+                symbol_table.symbol_count(),
+                symbol_table.scope_count()
+            );
+
+            // Register with workspace manager for cross-project navigation
+            if let Ok(file_path) = uri.to_file_path() {
+                let _t = perf::time("pipeline.workspace_publish");
+                let mut workspace = workspace.write().unwrap();
+                // Clone the symbol table for workspace (document keeps its own copy)
+                workspace.set_symbol_table(&file_path, symbol_table.clone());
+            }
+
+            doc.ast = once_cell::sync::OnceCell::with_value(ast);
+            doc.symbol_table = Some(symbol_table);
+            doc.tree = Some(tree);
+            doc.diagnostic_cache = diag_cache;
+            memory::touch(&doc);
         }
+
+        // Analysis is the point where resident state grows; evict the
+        // oldest documents' parse state if we are now over budget
+        memory::enforce_budget(documents);
+
+        // Publish diagnostics
+        client
+            .publish_diagnostics(uri.clone(), diagnostics, Some(version))
+            .await;
     }
 
     /// Get tree-sitter tree for a document (for external use)
     #[allow(dead_code)]
-    fn get_tree_for_uri(&self, _uri: &Url) -> Option<tree_sitter::Tree> {
-        let parser = self.parser.read().unwrap();
-        parser.get_tree().cloned()
+    fn get_tree_for_uri(&self, uri: &Url) -> Option<tree_sitter::Tree> {
+        self.documents.get(uri).and_then(|doc| doc.tree.clone())
     }
 
     /// Extract word at position from source
@@ -218,6 +531,30 @@ fn is_identifier_char(c: char) -> bool {
     c.is_alphanumeric() || c == '_'
 }
 
+/// Check that a rename target is a legal VB6 identifier: starts with a
+/// letter, contains only letters/digits/underscores, at most 255 chars
+fn is_valid_vb6_identifier(name: &str) -> bool {
+    let mut chars = name.chars();
+    matches!(chars.next(), Some(c) if c.is_alphabetic())
+        && chars.all(is_identifier_char)
+        && name.len() <= 255
+}
+
+/// Compute the end point of inserting `text` at `start` (byte columns)
+fn end_point_of_insert(start: tree_sitter::Point, text: &str) -> tree_sitter::Point {
+    let bytes = text.as_bytes();
+    match bytes.iter().rposition(|&b| b == b'\n') {
+        Some(last_newline) => tree_sitter::Point {
+            row: start.row + bytes.iter().filter(|&&b| b == b'\n').count(),
+            column: bytes.len() - last_newline - 1,
+        },
+        None => tree_sitter::Point {
+            row: start.row,
+            column: start.column + bytes.len(),
+        },
+    }
+}
+
 #[tower_lsp::async_trait]
 impl LanguageServer for Vb6LanguageServer {
     async fn initialize(&self, params: InitializeParams) -> Result<InitializeResult> {
@@ -280,8 +617,9 @@ impl LanguageServer for Vb6LanguageServer {
                 // Code actions (quick fixes, refactoring)
                 code_action_provider: Some(CodeActionProviderCapability::Simple(true)),
 
-                // Formatting
+                // Formatting (whole document and range)
                 document_formatting_provider: Some(OneOf::Left(true)),
+                document_range_formatting_provider: Some(OneOf::Left(true)),
 
                 // Rename
                 rename_provider: Some(OneOf::Right(RenameOptions {
@@ -289,30 +627,13 @@ impl LanguageServer for Vb6LanguageServer {
                     work_done_progress_options: Default::default(),
                 })),
 
-                // Semantic tokens for syntax highlighting
+                // Semantic tokens for syntax highlighting; the legend
+                // lives next to the encoder so the two cannot drift
                 semantic_tokens_provider: Some(
                     SemanticTokensServerCapabilities::SemanticTokensOptions(
                         SemanticTokensOptions {
-                            legend: SemanticTokensLegend {
-                                token_types: vec![
-                                    SemanticTokenType::KEYWORD,
-                                    SemanticTokenType::FUNCTION,
-                                    SemanticTokenType::VARIABLE,
-                                    SemanticTokenType::STRING,
-                                    SemanticTokenType::NUMBER,
-                                    SemanticTokenType::COMMENT,
-                                    SemanticTokenType::TYPE,
-                                    SemanticTokenType::CLASS,
-                                    SemanticTokenType::PROPERTY,
-                                    SemanticTokenType::PARAMETER,
-                                ],
-                                token_modifiers: vec![
-                                    SemanticTokenModifier::DECLARATION,
-                                    SemanticTokenModifier::DEFINITION,
-                                    SemanticTokenModifier::READONLY,
-                                ],
-                            },
-                            full: Some(SemanticTokensFullOptions::Bool(true)),
+                            legend: semantic_tokens::legend(),
+                            full: Some(SemanticTokensFullOptions::Delta { delta: Some(true) }),
                             range: Some(true),
                             ..Default::default()
                         },
@@ -333,6 +654,32 @@ impl LanguageServer for Vb6LanguageServer {
         self.client
             .log_message(MessageType::INFO, "VB6 Language Server ready!")
             .await;
+
+        // Watch .vbp files so new/removed projects are picked up without
+        // rescanning the workspace tree (best effort: clients without
+        // dynamic registration support just skip this)
+        let registration = Registration {
+            id: "vb6-lsp/vbp-watcher".to_string(),
+            method: "workspace/didChangeWatchedFiles".to_string(),
+            register_options: serde_json::to_value(DidChangeWatchedFilesRegistrationOptions {
+                watchers: vec![FileSystemWatcher {
+                    glob_pattern: GlobPattern::String("**/*.vbp".to_string()),
+                    kind: None,
+                }],
+            })
+            .ok(),
+        };
+        if let Err(e) = self.client.register_capability(vec![registration]).await {
+            tracing::debug!("Client rejected .vbp watcher registration: {}", e);
+        }
+
+        // Pre-parse all project members in the background so workspace-wide
+        // navigation works without opening each file first
+        let client = self.client.clone();
+        let workspace = Arc::clone(&self.workspace);
+        tokio::spawn(async move {
+            crate::workspace::index_workspace(client, workspace).await;
+        });
     }
 
     async fn shutdown(&self) -> Result<()> {
@@ -355,9 +702,13 @@ impl LanguageServer for Vb6LanguageServer {
                 content: Rope::from_str(&content),
                 version,
                 encoding: Encoding::Utf8, // LSP protocol uses UTF-8
-                ast: None,
+                parser: Arc::new(Mutex::new(Vb6Parser::new())),
+                ast: once_cell::sync::OnceCell::new(),
                 tree: None,
+                pending_edits: Vec::new(),
                 symbol_table: None,
+                diagnostic_cache: Default::default(),
+                last_touched: memory::tick().into(),
             },
         );
 
@@ -369,34 +720,88 @@ impl LanguageServer for Vb6LanguageServer {
 
         if let Some(mut doc) = self.documents.get_mut(&uri) {
             doc.version = params.text_document.version;
+            memory::touch(&doc);
 
             for change in params.content_changes {
                 if let Some(range) = change.range {
-                    // Incremental update
+                    // Incremental update; map the UTF-16 columns the
+                    // client sent through the line index
                     let start_line = range.start.line as usize;
-                    let start_char = range.start.character as usize;
                     let end_line = range.end.line as usize;
-                    let end_char = range.end.character as usize;
 
-                    let start_idx = doc.content.line_to_char(start_line) + start_char;
-                    let end_idx = doc.content.line_to_char(end_line) + end_char;
+                    let (start_idx, end_idx) = {
+                        let index = document::LineIndex::new(&doc.content);
+                        match (
+                            index.position_to_char(range.start),
+                            index.position_to_char(range.end),
+                        ) {
+                            (Some(s), Some(e)) => (s, e),
+                            _ => {
+                                tracing::warn!(
+                                    "Ignoring edit with out-of-range position in {}",
+                                    uri
+                                );
+                                continue;
+                            }
+                        }
+                    };
+
+                    // Describe the edit in byte coordinates for tree-sitter
+                    // before mutating the rope
+                    let start_byte = doc.content.char_to_byte(start_idx);
+                    let old_end_byte = doc.content.char_to_byte(end_idx);
+                    let start_point = tree_sitter::Point {
+                        row: start_line,
+                        column: start_byte - doc.content.line_to_byte(start_line),
+                    };
+                    let old_end_point = tree_sitter::Point {
+                        row: end_line,
+                        column: old_end_byte - doc.content.line_to_byte(end_line),
+                    };
 
                     doc.content.remove(start_idx..end_idx);
                     doc.content.insert(start_idx, &change.text);
+
+                    let new_end_byte = start_byte + change.text.len();
+                    let new_end_point = end_point_of_insert(start_point, &change.text);
+
+                    let edit = tree_sitter::InputEdit {
+                        start_byte,
+                        old_end_byte,
+                        new_end_byte,
+                        start_position: start_point,
+                        old_end_position: old_end_point,
+                        new_end_position: new_end_point,
+                    };
+
+                    // Feed the edit to the cached trees so the next parse
+                    // only revisits the changed region
+                    doc.parser.lock().unwrap().apply_edit(&edit);
+                    if let Some(tree) = doc.tree.as_mut() {
+                        tree.edit(&edit);
+                    }
+                    doc.pending_edits.push(edit);
                 } else {
-                    // Full replacement
+                    // Full replacement - incremental state is useless now
                     doc.content = Rope::from_str(&change.text);
+                    doc.parser.lock().unwrap().clear_cache();
+                    doc.tree = None;
+                    doc.pending_edits.clear();
                 }
             }
         }
 
-        self.parse_and_diagnose(&uri).await;
+        self.schedule_diagnostics(uri);
     }
 
     async fn did_close(&self, params: DidCloseTextDocumentParams) {
         let uri = params.text_document.uri;
         tracing::debug!("Document closed: {}", uri);
 
+        self.pending_diagnostics.remove(&uri);
+        self.completion_sessions.remove(&uri);
+        self.semantic_token_results.remove(&uri);
+
         // Remove from workspace manager
         if let Ok(file_path) = uri.to_file_path() {
             let mut workspace = self.workspace.write().unwrap();
@@ -406,6 +811,44 @@ impl LanguageServer for Vb6LanguageServer {
         self.documents.remove(&uri);
     }
 
+    async fn did_change_watched_files(&self, params: DidChangeWatchedFilesParams) {
+        let mut projects_changed = false;
+
+        for change in params.changes {
+            let Ok(path) = change.uri.to_file_path() else {
+                continue;
+            };
+            if !path
+                .extension()
+                .map_or(false, |ext| ext.eq_ignore_ascii_case("vbp"))
+            {
+                continue;
+            }
+
+            let mut workspace = self.workspace.write().unwrap();
+            // Drop the stale member list (and its index entries) first;
+            // for a deleted project that is all there is to do
+            workspace.unload_project(&path);
+            if change.typ != FileChangeType::DELETED {
+                match workspace.load_project(&path) {
+                    Ok(()) => projects_changed = true,
+                    Err(e) => tracing::warn!("Failed to load VBP {}: {}", path.display(), e),
+                }
+            } else {
+                tracing::info!("Project removed: {}", path.display());
+            }
+        }
+
+        // Index members of newly added/changed projects in the background
+        if projects_changed {
+            let client = self.client.clone();
+            let workspace = Arc::clone(&self.workspace);
+            tokio::spawn(async move {
+                crate::workspace::index_workspace(client, workspace).await;
+            });
+        }
+    }
+
     async fn did_save(&self, params: DidSaveTextDocumentParams) {
         let uri = params.text_document.uri;
         tracing::debug!("Document saved: {}", uri);
@@ -415,6 +858,7 @@ impl LanguageServer for Vb6LanguageServer {
 
     // Completion
     async fn completion(&self, params: CompletionParams) -> Result<Option<CompletionResponse>> {
+        let _timer = perf::time("lsp.completion");
         let uri = &params.text_document_position.text_document.uri;
         let position = params.text_document_position.position;
 
@@ -422,16 +866,58 @@ impl LanguageServer for Vb6LanguageServer {
 
         // Get completions from analyzer
         if let Some(doc) = self.documents.get(uri) {
+            memory::touch(&doc);
             let content = doc.content.to_string();
+            let (prefix, prefix_start) = typed_prefix(&content, position);
+            // Anchor context detection (e.g. the member-access dot) at the
+            // start of the typed prefix, not the cursor
+            let anchor = Position {
+                line: position.line,
+                character: prefix_start,
+            };
+
             // Prefer symbol table for context-aware completions
             if let Some(ref table) = doc.symbol_table {
-                let items = self.analyzer.get_completions_with_symbols(table, position, &content);
-                return Ok(Some(CompletionResponse::Array(items)));
+                // Reuse the previous pool when the user is extending the
+                // same prefix; otherwise collect a fresh candidate set
+                let cached = self.completion_sessions.remove(uri).map(|(_, s)| s);
+                let pool = match cached {
+                    Some(session)
+                        if session.version == doc.version
+                            && session.line == position.line
+                            && session.prefix_start == prefix_start
+                            && prefix.starts_with(&session.prefix) =>
+                    {
+                        session.pool
+                    }
+                    _ => self.analyzer.get_completions_with_symbols(table, anchor, &content),
+                };
+
+                let (items, is_incomplete) = crate::analysis::rank_completions(&prefix, &pool);
+                self.completion_sessions.insert(
+                    uri.clone(),
+                    CompletionSession {
+                        version: doc.version,
+                        line: position.line,
+                        prefix_start,
+                        prefix,
+                        pool,
+                    },
+                );
+
+                return Ok(Some(CompletionResponse::List(CompletionList {
+                    is_incomplete,
+                    items,
+                })));
             }
             // Fall back to AST-based completions
-            if let Some(ref ast) = doc.ast {
-                let items = self.analyzer.get_completions(ast, position);
-                return Ok(Some(CompletionResponse::Array(items)));
+            if let Some(ast) = doc.ast() {
+                let pool = self.analyzer.get_completions(ast, position);
+                let (items, is_incomplete) = crate::analysis::rank_completions(&prefix, &pool);
+                return Ok(Some(CompletionResponse::List(CompletionList {
+                    is_incomplete,
+                    items,
+                })));
             }
         }
 
@@ -440,16 +926,18 @@ impl LanguageServer for Vb6LanguageServer {
 
     // Hover
     async fn hover(&self, params: HoverParams) -> Result<Option<Hover>> {
+        let _timer = perf::time("lsp.hover");
         let uri = &params.text_document_position_params.text_document.uri;
         let position = params.text_document_position_params.position;
 
         if let Some(doc) = self.documents.get(uri) {
+            memory::touch(&doc);
             // Prefer symbol table for precise hover
             if let Some(ref table) = doc.symbol_table {
                 return Ok(self.analyzer.get_hover_with_symbols(table, position));
             }
             // Fall back to AST-based hover
-            if let Some(ref ast) = doc.ast {
+            if let Some(ast) = doc.ast() {
                 return Ok(self.analyzer.get_hover(ast, position));
             }
         }
@@ -462,10 +950,12 @@ impl LanguageServer for Vb6LanguageServer {
         &self,
         params: GotoDefinitionParams,
     ) -> Result<Option<GotoDefinitionResponse>> {
+        let _timer = perf::time("lsp.goto_definition");
         let uri = &params.text_document_position_params.text_document.uri;
         let position = params.text_document_position_params.position;
 
         if let Some(doc) = self.documents.get(uri) {
+            memory::touch(&doc);
             let content = doc.content.to_string();
             // Prefer symbol table for precise definition lookup
             if let Some(ref table) = doc.symbol_table {
@@ -486,7 +976,7 @@ impl LanguageServer for Vb6LanguageServer {
                 }
             }
             // Fall back to AST-based definition
-            if let Some(ref ast) = doc.ast {
+            if let Some(ast) = doc.ast() {
                 return Ok(self.analyzer.get_definition(ast, position, uri));
             }
         }
@@ -496,16 +986,18 @@ impl LanguageServer for Vb6LanguageServer {
 
     // Find references
     async fn references(&self, params: ReferenceParams) -> Result<Option<Vec<Location>>> {
+        let _timer = perf::time("lsp.references");
         let uri = &params.text_document_position.text_document.uri;
         let position = params.text_document_position.position;
 
         if let Some(doc) = self.documents.get(uri) {
             // Prefer symbol table for precise references
             if let Some(ref table) = doc.symbol_table {
-                return Ok(Some(self.analyzer.get_references_with_symbols(table, position)));
+                let content = doc.content.to_string();
+                return Ok(Some(self.reference_locations(table, &content, uri, position)));
             }
             // Fall back to AST-based references
-            if let Some(ref ast) = doc.ast {
+            if let Some(ast) = doc.ast() {
                 return Ok(Some(self.analyzer.get_references(ast, position, uri)));
             }
         }
@@ -518,6 +1010,7 @@ impl LanguageServer for Vb6LanguageServer {
         &self,
         params: DocumentSymbolParams,
     ) -> Result<Option<DocumentSymbolResponse>> {
+        let _timer = perf::time("lsp.document_symbol");
         let uri = &params.text_document.uri;
 
         if let Some(doc) = self.documents.get(uri) {
@@ -527,7 +1020,7 @@ impl LanguageServer for Vb6LanguageServer {
                 return Ok(Some(DocumentSymbolResponse::Nested(symbols)));
             }
             // Fall back to AST-based symbols
-            if let Some(ref ast) = doc.ast {
+            if let Some(ast) = doc.ast() {
                 let symbols = self.analyzer.get_document_symbols(ast);
                 return Ok(Some(DocumentSymbolResponse::Nested(symbols)));
             }
@@ -536,13 +1029,43 @@ impl LanguageServer for Vb6LanguageServer {
         Ok(None)
     }
 
+    // Workspace symbols
+    async fn symbol(
+        &self,
+        params: WorkspaceSymbolParams,
+    ) -> Result<Option<Vec<SymbolInformation>>> {
+        let _timer = perf::time("lsp.workspace_symbol");
+        // Served entirely from the workspace symbol index; ranked
+        // fuzzy matching, capped so huge workspaces stay responsive
+        const MAX_RESULTS: usize = 256;
+
+        let workspace = self.workspace.read().unwrap();
+        #[allow(deprecated)]
+        let symbols = workspace
+            .symbol_index()
+            .query(&params.query, MAX_RESULTS)
+            .into_iter()
+            .map(|posting| SymbolInformation {
+                name: posting.name.to_string(),
+                kind: posting.kind.to_lsp(),
+                tags: None,
+                deprecated: None,
+                location: posting.location.clone(),
+                container_name: None,
+            })
+            .collect();
+
+        Ok(Some(symbols))
+    }
+
     // Code actions
     async fn code_action(&self, params: CodeActionParams) -> Result<Option<CodeActionResponse>> {
+        let _timer = perf::time("lsp.code_action");
         let uri = &params.text_document.uri;
         let range = params.range;
 
         if let Some(doc) = self.documents.get(uri) {
-            if let Some(ref ast) = doc.ast {
+            if let Some(ast) = doc.ast() {
                 let actions = self.analyzer.get_code_actions(ast, range, &params.context);
 
                 // If Claude is available, add AI-powered actions
@@ -559,29 +1082,206 @@ impl LanguageServer for Vb6LanguageServer {
 
     // Formatting
     async fn formatting(&self, params: DocumentFormattingParams) -> Result<Option<Vec<TextEdit>>> {
+        let _timer = perf::time("lsp.formatting");
         let uri = &params.text_document.uri;
 
         if let Some(doc) = self.documents.get(uri) {
             let content = doc.content.to_string();
-            let parser = self.parser.read().unwrap();
+            let parser = doc.parser.lock().unwrap();
             return Ok(parser.format(&content));
         }
 
         Ok(None)
     }
 
-    // Rename
+    // Range formatting: re-indent only the requested lines, deriving the
+    // starting indent from the lines above the span
+    async fn range_formatting(
+        &self,
+        params: DocumentRangeFormattingParams,
+    ) -> Result<Option<Vec<TextEdit>>> {
+        let _timer = perf::time("lsp.range_formatting");
+        let uri = &params.text_document.uri;
+
+        if let Some(doc) = self.documents.get(uri) {
+            let content = doc.content.to_string();
+            let parser = doc.parser.lock().unwrap();
+            return Ok(parser.format_range(
+                &content,
+                params.range.start.line as usize,
+                params.range.end.line as usize,
+            ));
+        }
+
+        Ok(None)
+    }
+
+    // Rename: rewrite every reference the cross-project engine finds,
+    // grouped into per-file edit lists
     async fn rename(&self, params: RenameParams) -> Result<Option<WorkspaceEdit>> {
+        let _timer = perf::time("lsp.rename");
         let uri = &params.text_document_position.text_document.uri;
         let position = params.text_document_position.position;
         let new_name = params.new_name;
 
+        if !is_valid_vb6_identifier(&new_name) {
+            return Err(tower_lsp::jsonrpc::Error::invalid_params(format!(
+                "'{}' is not a valid VB6 identifier",
+                new_name
+            )));
+        }
+
         if let Some(doc) = self.documents.get(uri) {
-            if let Some(ref ast) = doc.ast {
+            if let Some(ref table) = doc.symbol_table {
+                let content = doc.content.to_string();
+                let locations = self.reference_locations(table, &content, uri, position);
+                if locations.is_empty() {
+                    return Ok(None);
+                }
+
+                let mut changes: std::collections::HashMap<Url, Vec<TextEdit>> =
+                    std::collections::HashMap::new();
+                for location in locations {
+                    changes.entry(location.uri).or_default().push(TextEdit {
+                        range: location.range,
+                        new_text: new_name.clone(),
+                    });
+                }
+
+                // Clients apply each file's edits bottom-up; keep them
+                // sorted so overlapping-range validation is cheap
+                for edits in changes.values_mut() {
+                    edits.sort_by_key(|e| (e.range.start.line, e.range.start.character));
+                }
+
+                return Ok(Some(WorkspaceEdit {
+                    changes: Some(changes),
+                    ..Default::default()
+                }));
+            }
+            // Fall back to AST-based rename
+            if let Some(ast) = doc.ast() {
                 return Ok(self.analyzer.rename(ast, position, &new_name, uri));
             }
         }
 
         Ok(None)
     }
+
+    // Rename pre-check: answers from the position index alone, without
+    // touching any other file
+    async fn prepare_rename(
+        &self,
+        params: TextDocumentPositionParams,
+    ) -> Result<Option<PrepareRenameResponse>> {
+        let uri = &params.text_document.uri;
+        let position = params.position;
+
+        if let Some(doc) = self.documents.get(uri) {
+            if let Some(ref table) = doc.symbol_table {
+                let pos = crate::analysis::SourcePosition::from_lsp(position);
+
+                // On a declaration name
+                if let Some(symbol) = table.symbol_at_position(pos) {
+                    return Ok(Some(PrepareRenameResponse::Range(
+                        symbol.name_range.to_lsp(),
+                    )));
+                }
+                // On a resolved reference
+                if let Some(reference) = table.reference_at_position(pos) {
+                    return Ok(Some(PrepareRenameResponse::Range(reference.range.to_lsp())));
+                }
+            }
+        }
+
+        Ok(None)
+    }
+
+    // Semantic tokens (full document)
+    async fn semantic_tokens_full(
+        &self,
+        params: SemanticTokensParams,
+    ) -> Result<Option<SemanticTokensResult>> {
+        let _timer = perf::time("lsp.semantic_tokens_full");
+        let uri = params.text_document.uri;
+
+        if let Some(doc) = self.documents.get(&uri) {
+            memory::touch(&doc);
+            if let Some(ref tree) = doc.tree {
+                let tokens = semantic_tokens::compute_tokens(tree, None);
+                let result_id = semantic_tokens::next_result_id();
+                self.semantic_token_results
+                    .insert(uri.clone(), (result_id.clone(), tokens.clone()));
+
+                return Ok(Some(SemanticTokensResult::Tokens(SemanticTokens {
+                    result_id: Some(result_id),
+                    data: tokens,
+                })));
+            }
+        }
+
+        Ok(None)
+    }
+
+    // Semantic tokens (delta against a previous full result)
+    async fn semantic_tokens_full_delta(
+        &self,
+        params: SemanticTokensDeltaParams,
+    ) -> Result<Option<SemanticTokensFullDeltaResult>> {
+        let _timer = perf::time("lsp.semantic_tokens_delta");
+        let uri = params.text_document.uri;
+
+        if let Some(doc) = self.documents.get(&uri) {
+            if let Some(ref tree) = doc.tree {
+                let tokens = semantic_tokens::compute_tokens(tree, None);
+                let result_id = semantic_tokens::next_result_id();
+
+                let previous = self
+                    .semantic_token_results
+                    .insert(uri.clone(), (result_id.clone(), tokens.clone()));
+
+                // Only diff against the result the client says it holds;
+                // anything else gets a fresh full stream
+                if let Some((prev_id, prev_tokens)) = previous {
+                    if prev_id == params.previous_result_id {
+                        let edits = semantic_tokens::token_edits(&prev_tokens, &tokens);
+                        return Ok(Some(SemanticTokensFullDeltaResult::TokensDelta(
+                            SemanticTokensDelta {
+                                result_id: Some(result_id),
+                                edits,
+                            },
+                        )));
+                    }
+                }
+
+                return Ok(Some(SemanticTokensFullDeltaResult::Tokens(SemanticTokens {
+                    result_id: Some(result_id),
+                    data: tokens,
+                })));
+            }
+        }
+
+        Ok(None)
+    }
+
+    // Semantic tokens (visible range only; not cached)
+    async fn semantic_tokens_range(
+        &self,
+        params: SemanticTokensRangeParams,
+    ) -> Result<Option<SemanticTokensRangeResult>> {
+        let _timer = perf::time("lsp.semantic_tokens_range");
+        let uri = params.text_document.uri;
+
+        if let Some(doc) = self.documents.get(&uri) {
+            if let Some(ref tree) = doc.tree {
+                let tokens = semantic_tokens::compute_tokens(tree, Some(params.range));
+                return Ok(Some(SemanticTokensRangeResult::Tokens(SemanticTokens {
+                    result_id: None,
+                    data: tokens,
+                })));
+            }
+        }
+
+        Ok(None)
+    }
 }
@@ -0,0 +1,271 @@
+//! Semantic token computation from tree-sitter trees
+//!
+//! Walks the stored `Document.tree` and classifies leaf nodes against
+//! the legend advertised in `initialize`, so highlighting never
+//! re-tokenizes text the parser has already structured. Full, range,
+//! and delta requests all share the same walk; delta responses diff the
+//! previous token stream and transmit only the changed middle run.
+
+use std::sync::atomic::{AtomicU64, Ordering};
+
+use tower_lsp::lsp_types::*;
+use tree_sitter::{Node, Tree};
+
+// Indices into the legend below; keep the two in sync
+const TOKEN_KEYWORD: u32 = 0;
+const TOKEN_FUNCTION: u32 = 1;
+const TOKEN_VARIABLE: u32 = 2;
+const TOKEN_STRING: u32 = 3;
+const TOKEN_NUMBER: u32 = 4;
+const TOKEN_COMMENT: u32 = 5;
+const TOKEN_TYPE: u32 = 6;
+#[allow(dead_code)]
+const TOKEN_CLASS: u32 = 7;
+const TOKEN_PROPERTY: u32 = 8;
+const TOKEN_PARAMETER: u32 = 9;
+
+const MOD_DECLARATION: u32 = 1 << 0;
+const MOD_DEFINITION: u32 = 1 << 1;
+const MOD_READONLY: u32 = 1 << 2;
+
+/// The legend advertised in `initialize`; the encoder indexes into this
+pub fn legend() -> SemanticTokensLegend {
+    SemanticTokensLegend {
+        token_types: vec![
+            SemanticTokenType::KEYWORD,
+            SemanticTokenType::FUNCTION,
+            SemanticTokenType::VARIABLE,
+            SemanticTokenType::STRING,
+            SemanticTokenType::NUMBER,
+            SemanticTokenType::COMMENT,
+            SemanticTokenType::TYPE,
+            SemanticTokenType::CLASS,
+            SemanticTokenType::PROPERTY,
+            SemanticTokenType::PARAMETER,
+        ],
+        token_modifiers: vec![
+            SemanticTokenModifier::DECLARATION,
+            SemanticTokenModifier::DEFINITION,
+            SemanticTokenModifier::READONLY,
+        ],
+    }
+}
+
+/// Hand out a fresh result id for caching full-token responses
+pub fn next_result_id() -> String {
+    static COUNTER: AtomicU64 = AtomicU64::new(1);
+    COUNTER.fetch_add(1, Ordering::Relaxed).to_string()
+}
+
+/// Compute delta-encoded semantic tokens for a tree, optionally limited
+/// to the lines covered by `range`.
+pub fn compute_tokens(tree: &Tree, range: Option<Range>) -> Vec<SemanticToken> {
+    let (first_line, last_line) = match range {
+        Some(r) => (r.start.line as usize, r.end.line as usize),
+        None => (0, usize::MAX),
+    };
+
+    let mut tokens = Vec::new();
+    let mut cursor = tree.walk();
+    let mut prev_line = 0u32;
+    let mut prev_start = 0u32;
+
+    'walk: loop {
+        let node = cursor.node();
+        let start = node.start_position();
+        let end = node.end_position();
+
+        // Prune subtrees entirely outside the requested line window
+        if start.row > last_line || end.row < first_line {
+            // Fall through to sibling/parent navigation without descending
+        } else {
+            if node.child_count() == 0 && start.row == end.row && start.row >= first_line {
+                if let Some((token_type, modifiers)) = classify(&node) {
+                    let line = start.row as u32;
+                    let col = start.column as u32;
+                    let delta_line = line - prev_line;
+                    let delta_start = if delta_line == 0 { col - prev_start } else { col };
+
+                    tokens.push(SemanticToken {
+                        delta_line,
+                        delta_start,
+                        length: (end.column - start.column) as u32,
+                        token_type,
+                        token_modifiers_bitset: modifiers,
+                    });
+                    prev_line = line;
+                    prev_start = col;
+                }
+            }
+
+            if cursor.goto_first_child() {
+                continue;
+            }
+        }
+
+        loop {
+            if cursor.goto_next_sibling() {
+                continue 'walk;
+            }
+            if !cursor.goto_parent() {
+                break 'walk;
+            }
+        }
+    }
+
+    tokens
+}
+
+/// Map a leaf node to (legend index, modifier bitset)
+fn classify(node: &Node) -> Option<(u32, u32)> {
+    let kind = node.kind();
+
+    match kind {
+        "comment" => return Some((TOKEN_COMMENT, 0)),
+        "string_literal" => return Some((TOKEN_STRING, 0)),
+        "integer_literal" | "float_literal" | "date_literal_token" => {
+            return Some((TOKEN_NUMBER, 0))
+        }
+        "identifier" | "callable_identifier" => return classify_identifier(node),
+        _ => {}
+    }
+
+    // Anonymous alphabetic tokens are grammar keywords (If, Dim, Sub, ...)
+    if !node.is_named() && kind.chars().next().map_or(false, |c| c.is_alphabetic()) {
+        return Some((TOKEN_KEYWORD, 0));
+    }
+
+    None
+}
+
+/// Identifiers are classified by where they sit in the tree
+fn classify_identifier(node: &Node) -> Option<(u32, u32)> {
+    let parent = match node.parent() {
+        Some(p) => p,
+        None => return Some((TOKEN_VARIABLE, 0)),
+    };
+    let is_name = parent
+        .child_by_field_name("name")
+        .map_or(false, |n| n.id() == node.id());
+
+    let classified = match parent.kind() {
+        "sub_declaration" | "function_declaration" | "declare_statement" if is_name => {
+            (TOKEN_FUNCTION, MOD_DEFINITION)
+        }
+        "property_declaration" if is_name => (TOKEN_PROPERTY, MOD_DEFINITION),
+        "type_declaration" | "enum_declaration" if is_name => (TOKEN_TYPE, MOD_DEFINITION),
+        "as_clause" | "form_type_name" => (TOKEN_TYPE, 0),
+        "parameter" => (TOKEN_PARAMETER, MOD_DECLARATION),
+        "constant_declaration" if is_name => (TOKEN_VARIABLE, MOD_DECLARATION | MOD_READONLY),
+        "variable_declarator" | "variable_declaration" if is_name => {
+            (TOKEN_VARIABLE, MOD_DECLARATION)
+        }
+        _ => (TOKEN_VARIABLE, 0),
+    };
+
+    Some(classified)
+}
+
+/// Diff two token streams into the minimal single-span edit.
+///
+/// Token streams from successive parses share long common prefixes and
+/// suffixes (an edit only reorders deltas near the change), so one edit
+/// over the differing middle run keeps delta responses small. Units are
+/// `u32`s of the flattened data array, per the LSP spec.
+pub fn token_edits(old: &[SemanticToken], new: &[SemanticToken]) -> Vec<SemanticTokensEdit> {
+    let common_prefix = old
+        .iter()
+        .zip(new.iter())
+        .take_while(|(a, b)| a == b)
+        .count();
+
+    let common_suffix = old[common_prefix..]
+        .iter()
+        .rev()
+        .zip(new[common_prefix..].iter().rev())
+        .take_while(|(a, b)| a == b)
+        .count();
+
+    let deleted = old.len() - common_prefix - common_suffix;
+    let inserted = &new[common_prefix..new.len() - common_suffix];
+
+    if deleted == 0 && inserted.is_empty() {
+        return Vec::new();
+    }
+
+    vec![SemanticTokensEdit {
+        start: (common_prefix * 5) as u32,
+        delete_count: (deleted * 5) as u32,
+        data: Some(inserted.to_vec()),
+    }]
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::parser::TreeSitterVb6Parser;
+
+    fn parse(source: &str) -> Tree {
+        let mut parser = TreeSitterVb6Parser::new().unwrap();
+        parser.parse(source, None).unwrap()
+    }
+
+    #[test]
+    fn test_compute_tokens_classifies_declarations() {
+        let source = "Dim count As Integer\n\nSub Main()\n    count = 42 ' update\nEnd Sub\n";
+        let tree = parse(source);
+        let tokens = compute_tokens(&tree, None);
+        assert!(!tokens.is_empty());
+
+        // First token is the Dim keyword at the file start
+        let first = &tokens[0];
+        assert_eq!(first.delta_line, 0);
+        assert_eq!(first.delta_start, 0);
+        assert_eq!(first.token_type, TOKEN_KEYWORD);
+
+        assert!(tokens.iter().any(|t| t.token_type == TOKEN_NUMBER));
+        assert!(tokens.iter().any(|t| t.token_type == TOKEN_COMMENT));
+        assert!(tokens
+            .iter()
+            .any(|t| t.token_type == TOKEN_FUNCTION && t.token_modifiers_bitset == MOD_DEFINITION));
+    }
+
+    #[test]
+    fn test_range_limits_lines() {
+        let source = "Dim a As Integer\nDim b As Integer\nDim c As Integer\n";
+        let tree = parse(source);
+
+        let all = compute_tokens(&tree, None);
+        let middle = compute_tokens(
+            &tree,
+            Some(Range {
+                start: Position { line: 1, character: 0 },
+                end: Position { line: 1, character: 99 },
+            }),
+        );
+        assert!(middle.len() < all.len());
+        assert!(!middle.is_empty());
+    }
+
+    #[test]
+    fn test_token_edits_single_middle_span() {
+        let tok = |ty: u32| SemanticToken {
+            delta_line: 1,
+            delta_start: 0,
+            length: 3,
+            token_type: ty,
+            token_modifiers_bitset: 0,
+        };
+
+        let old = vec![tok(0), tok(1), tok(2), tok(3)];
+        let new = vec![tok(0), tok(4), tok(5), tok(3)];
+
+        let edits = token_edits(&old, &new);
+        assert_eq!(edits.len(), 1);
+        assert_eq!(edits[0].start, 5);
+        assert_eq!(edits[0].delete_count, 10);
+        assert_eq!(edits[0].data.as_ref().unwrap().len(), 2);
+
+        assert!(token_edits(&old, &old).is_empty());
+    }
+}
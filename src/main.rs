@@ -43,7 +43,10 @@ async fn main() -> anyhow::Result<()> {
     let stdin = tokio::io::stdin();
     let stdout = tokio::io::stdout();
 
-    let (service, socket) = LspService::new(|client| Vb6LanguageServer::new(client));
+    let (service, socket) = LspService::build(|client| Vb6LanguageServer::new(client))
+        .custom_method("vb6/perfStats", Vb6LanguageServer::perf_stats)
+        .custom_method("vb6/memoryStats", Vb6LanguageServer::memory_stats)
+        .finish();
 
     // Run the server
     Server::new(stdin, stdout, socket).serve(service).await;
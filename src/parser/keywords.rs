@@ -0,0 +1,135 @@
+//! Case-Folded Keyword Recognition
+//!
+//! Allocation-free, case-insensitive keyword and substring matching for
+//! the tokenization paths that cannot lean on tree-sitter: the legacy
+//! line parser and the lexer. Keywords live in a static table bucketed
+//! by length, so a lookup compares the probe against only the handful of
+//! candidates of its own length, byte-wise and without uppercasing the
+//! input first. The external scanner in tree-sitter-vb6 uses the same
+//! bucketing scheme for its (deliberately different) reserved-word set.
+
+/// VB6 language keywords in canonical uppercase, indexed by length.
+/// Buckets are sorted so the table doubles as documentation.
+static KEYWORDS_BY_LEN: [&[&str]; 11] = [
+    &[],
+    &[],
+    &["AS", "DO", "IF", "IN", "IS", "ON", "OR", "TO"],
+    &[
+        "AND", "DIM", "END", "FOR", "GET", "LET", "LIB", "MOD", "NEW", "NOT", "REM", "SET", "SUB",
+        "XOR",
+    ],
+    &[
+        "BYTE", "CALL", "CASE", "DATE", "EACH", "ELSE", "ENUM", "EXIT", "GOTO", "LIKE", "LONG",
+        "LOOP", "NEXT", "NULL", "STEP", "STOP", "THEN", "TYPE", "WEND", "WITH",
+    ],
+    &[
+        "BYREF", "BYVAL", "CLASS", "CONST", "EVENT", "GOSUB", "REDIM", "UNTIL", "WHILE",
+    ],
+    &[
+        "DOUBLE", "ELSEIF", "FRIEND", "GLOBAL", "MODULE", "OBJECT", "OPTION", "PUBLIC", "RESUME",
+        "RETURN", "SELECT", "SINGLE", "STATIC", "STRING", "TYPEOF",
+    ],
+    &[
+        "BOOLEAN", "DECLARE", "INTEGER", "NOTHING", "PRIVATE", "VARIANT",
+    ],
+    &[
+        "CURRENCY", "FUNCTION", "OPTIONAL", "PRESERVE", "PROPERTY",
+    ],
+    &[],
+    &["IMPLEMENTS", "RAISEEVENT", "WITHEVENTS"],
+];
+
+/// Look up a word in the keyword table, case-insensitively, returning
+/// its canonical uppercase spelling. No allocation: the probe is
+/// compared byte-wise against its length bucket only.
+pub fn keyword(word: &str) -> Option<&'static str> {
+    let bucket = KEYWORDS_BY_LEN.get(word.len())?;
+    bucket
+        .iter()
+        .find(|kw| kw.eq_ignore_ascii_case(word))
+        .copied()
+}
+
+/// Check whether a word is a VB6 keyword (case-insensitive)
+pub fn is_keyword(word: &str) -> bool {
+    keyword(word).is_some()
+}
+
+/// Case-insensitive `starts_with` without uppercasing the haystack
+pub fn starts_with_ci(haystack: &str, prefix: &str) -> bool {
+    haystack
+        .as_bytes()
+        .get(..prefix.len())
+        .is_some_and(|head| head.eq_ignore_ascii_case(prefix.as_bytes()))
+}
+
+/// Case-insensitive substring search. Scans for positions matching the
+/// needle's first byte (either case) before attempting a full
+/// comparison, so non-matching lines cost one byte test per position
+/// instead of a window comparison.
+pub fn find_ci(haystack: &str, needle: &str) -> Option<usize> {
+    if needle.is_empty() {
+        return Some(0);
+    }
+
+    let haystack = haystack.as_bytes();
+    let needle = needle.as_bytes();
+    if haystack.len() < needle.len() {
+        return None;
+    }
+
+    let first_lower = needle[0].to_ascii_lowercase();
+    for (i, window) in haystack.windows(needle.len()).enumerate() {
+        if window[0].to_ascii_lowercase() == first_lower && window.eq_ignore_ascii_case(needle) {
+            return Some(i);
+        }
+    }
+
+    None
+}
+
+/// Case-insensitive `contains`
+pub fn contains_ci(haystack: &str, needle: &str) -> bool {
+    find_ci(haystack, needle).is_some()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_keyword_lookup_is_case_insensitive() {
+        assert_eq!(keyword("function"), Some("FUNCTION"));
+        assert_eq!(keyword("Function"), Some("FUNCTION"));
+        assert_eq!(keyword("FUNCTION"), Some("FUNCTION"));
+        assert_eq!(keyword("WithEvents"), Some("WITHEVENTS"));
+        assert_eq!(keyword("myVariable"), None);
+        assert_eq!(keyword(""), None);
+    }
+
+    #[test]
+    fn test_buckets_hold_correct_lengths() {
+        for (len, bucket) in KEYWORDS_BY_LEN.iter().enumerate() {
+            for kw in *bucket {
+                assert_eq!(kw.len(), len, "{} is in the length-{} bucket", kw, len);
+                assert!(is_keyword(kw));
+            }
+        }
+    }
+
+    #[test]
+    fn test_starts_with_ci() {
+        assert!(starts_with_ci("Private Sub Foo", "PRIVATE "));
+        assert!(starts_with_ci("OPTION EXPLICIT", "Option "));
+        assert!(!starts_with_ci("Print x", "PRIVATE"));
+        assert!(!starts_with_ci("Dim", "DIM ")); // prefix longer than line
+    }
+
+    #[test]
+    fn test_find_ci() {
+        assert_eq!(find_ci("Public Function Foo()", " function "), Some(6));
+        assert_eq!(find_ci("x = Sin(y)", " SUB "), None);
+        assert_eq!(find_ci("", "SUB"), None);
+        assert_eq!(find_ci("anything", ""), Some(0));
+    }
+}
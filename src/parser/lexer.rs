@@ -2,6 +2,8 @@
 //!
 //! Tokenizes VB6 source code for parsing.
 
+use super::keywords;
+
 #[derive(Debug, Clone, PartialEq)]
 pub enum Token {
     // Keywords
@@ -191,14 +193,14 @@ impl Lexer {
 
             Some(ch) if ch.is_alphabetic() || ch == '_' => {
                 let identifier = self.read_identifier();
-                let upper = identifier.to_uppercase();
 
-                // Check for keywords
-                if is_keyword(&upper) {
-                    Token::Keyword(upper)
-                } else if upper == "TRUE" {
+                // Check for keywords without uppercasing the identifier;
+                // the shared table hands back the canonical spelling
+                if let Some(canonical) = keywords::keyword(&identifier) {
+                    Token::Keyword(canonical.to_string())
+                } else if identifier.eq_ignore_ascii_case("TRUE") {
                     Token::BooleanLiteral(true)
-                } else if upper == "FALSE" {
+                } else if identifier.eq_ignore_ascii_case("FALSE") {
                     Token::BooleanLiteral(false)
                 } else {
                     Token::Identifier(identifier)
@@ -321,89 +323,3 @@ impl Lexer {
         tokens
     }
 }
-
-fn is_keyword(word: &str) -> bool {
-    matches!(
-        word,
-        "AS"
-            | "AND"
-            | "BOOLEAN"
-            | "BYREF"
-            | "BYTE"
-            | "BYVAL"
-            | "CALL"
-            | "CASE"
-            | "CLASS"
-            | "CONST"
-            | "CURRENCY"
-            | "DATE"
-            | "DECLARE"
-            | "DIM"
-            | "DO"
-            | "DOUBLE"
-            | "EACH"
-            | "ELSE"
-            | "ELSEIF"
-            | "END"
-            | "ENUM"
-            | "EVENT"
-            | "EXIT"
-            | "FOR"
-            | "FRIEND"
-            | "FUNCTION"
-            | "GET"
-            | "GLOBAL"
-            | "GOSUB"
-            | "GOTO"
-            | "IF"
-            | "IMPLEMENTS"
-            | "IN"
-            | "INTEGER"
-            | "IS"
-            | "LET"
-            | "LIB"
-            | "LIKE"
-            | "LONG"
-            | "LOOP"
-            | "MOD"
-            | "MODULE"
-            | "NEW"
-            | "NEXT"
-            | "NOT"
-            | "NOTHING"
-            | "NULL"
-            | "OBJECT"
-            | "ON"
-            | "OPTION"
-            | "OPTIONAL"
-            | "OR"
-            | "PRESERVE"
-            | "PRIVATE"
-            | "PROPERTY"
-            | "PUBLIC"
-            | "RAISEEVENT"
-            | "REDIM"
-            | "REM"
-            | "RESUME"
-            | "RETURN"
-            | "SELECT"
-            | "SET"
-            | "SINGLE"
-            | "STATIC"
-            | "STEP"
-            | "STOP"
-            | "STRING"
-            | "SUB"
-            | "THEN"
-            | "TO"
-            | "TYPE"
-            | "TYPEOF"
-            | "UNTIL"
-            | "VARIANT"
-            | "WEND"
-            | "WHILE"
-            | "WITH"
-            | "WITHEVENTS"
-            | "XOR"
-    )
-}
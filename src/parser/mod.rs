@@ -7,12 +7,15 @@
 
 mod lexer;
 mod ast;
+mod keywords;
 mod tree_sitter;
 mod converter;
 
+use keywords::{contains_ci, starts_with_ci};
+
 pub use ast::*;
 pub use tree_sitter::{TreeSitterVb6Parser, VB6QueryRunner};
-pub use converter::ParseErrorInfo;
+pub use converter::{convert_tree, ParseErrorInfo};
 
 use tower_lsp::lsp_types::{Position, Range, TextEdit};
 
@@ -86,6 +89,52 @@ impl Vb6Parser {
         }
     }
 
+    /// Record a text edit against the cached tree so the next parse
+    /// reuses unchanged subtrees (true incremental parsing)
+    pub fn apply_edit(&mut self, edit: &::tree_sitter::InputEdit) {
+        if let Some(tree) = self.last_tree.as_mut() {
+            tree.edit(edit);
+        }
+    }
+
+    /// Parse VB6 source from a rope, reading chunks in place.
+    ///
+    /// Combined with `apply_edit`, a small edit only reparses the affected
+    /// region instead of the whole document. Returns the new tree; the tree
+    /// is also cached for the next incremental parse.
+    pub fn parse_rope(&mut self, rope: &ropey::Rope) -> Option<::tree_sitter::Tree> {
+        let tree = self.ts_parser.parse_rope(rope, self.last_tree.as_ref());
+        if let Some(ref t) = tree {
+            self.last_tree = Some(t.clone());
+        }
+        tree
+    }
+
+    /// Convert an already-parsed tree into a Vb6Ast
+    pub fn ast_from_tree(tree: &::tree_sitter::Tree, source: &str) -> Vb6Ast {
+        converter::convert_tree(tree, source)
+    }
+
+    /// Extract parse errors from an already-parsed tree
+    pub fn errors_from_tree(tree: &::tree_sitter::Tree, source: &str) -> Vec<ParseError> {
+        converter::extract_errors(tree, source)
+            .into_iter()
+            .map(|e| ParseError {
+                message: e.message,
+                range: Range {
+                    start: Position {
+                        line: e.line as u32,
+                        character: e.column as u32,
+                    },
+                    end: Position {
+                        line: e.end_line as u32,
+                        character: e.end_column as u32,
+                    },
+                },
+            })
+            .collect()
+    }
+
     /// Get parse errors without failing the entire parse
     pub fn get_errors(&mut self, source: &str) -> Vec<ParseError> {
         if let Some(tree) = self.ts_parser.parse(source, self.last_tree.as_ref()) {
@@ -147,60 +196,67 @@ impl Vb6Parser {
         }
     }
 
-    /// Parse a single line of VB6 code
+    /// Parse a single line of VB6 code. Dispatch is allocation-free:
+    /// prefixes and substrings are matched case-insensitively in place
+    /// instead of uppercasing every line first.
     fn parse_line(
         &self,
         line: &str,
         line_num: usize,
         ast: &mut Vb6Ast,
     ) -> std::result::Result<(), ParseError> {
-        let upper = line.to_uppercase();
-
         // Comment
-        if upper.starts_with("'") || upper.starts_with("REM ") {
+        if line.starts_with('\'') || starts_with_ci(line, "REM ") {
             ast.add_comment(line_num, line);
             return Ok(());
         }
 
         // Option statements
-        if upper.starts_with("OPTION ") {
+        if starts_with_ci(line, "OPTION ") {
             ast.add_option(line_num, line);
             return Ok(());
         }
 
         // Attribute statements (in .cls/.frm files)
-        if upper.starts_with("ATTRIBUTE ") {
+        if starts_with_ci(line, "ATTRIBUTE ") {
             ast.add_attribute(line_num, line);
             return Ok(());
         }
 
         // Variable declarations
-        if upper.starts_with("DIM ")
-            || upper.starts_with("PRIVATE ")
-            || upper.starts_with("PUBLIC ")
-            || upper.starts_with("GLOBAL ")
-            || upper.starts_with("STATIC ")
+        if starts_with_ci(line, "DIM ")
+            || starts_with_ci(line, "PRIVATE ")
+            || starts_with_ci(line, "PUBLIC ")
+            || starts_with_ci(line, "GLOBAL ")
+            || starts_with_ci(line, "STATIC ")
         {
             return self.parse_declaration(line, line_num, ast);
         }
 
         // Const declarations
-        if upper.starts_with("CONST ") || upper.contains(" CONST ") {
+        if starts_with_ci(line, "CONST ") || contains_ci(line, " CONST ") {
             return self.parse_const(line, line_num, ast);
         }
 
         // Type declarations
-        if upper.starts_with("TYPE ") || upper.starts_with("PRIVATE TYPE ") || upper.starts_with("PUBLIC TYPE ") {
+        if starts_with_ci(line, "TYPE ")
+            || starts_with_ci(line, "PRIVATE TYPE ")
+            || starts_with_ci(line, "PUBLIC TYPE ")
+        {
             return self.parse_type(line, line_num, ast);
         }
 
         // Enum declarations
-        if upper.starts_with("ENUM ") || upper.starts_with("PRIVATE ENUM ") || upper.starts_with("PUBLIC ENUM ") {
+        if starts_with_ci(line, "ENUM ")
+            || starts_with_ci(line, "PRIVATE ENUM ")
+            || starts_with_ci(line, "PUBLIC ENUM ")
+        {
             return self.parse_enum(line, line_num, ast);
         }
 
         // Sub/Function/Property declarations
-        if upper.contains("SUB ") || upper.contains("FUNCTION ") || upper.contains("PROPERTY ") {
+        if contains_ci(line, "SUB ") || contains_ci(line, "FUNCTION ") || contains_ci(line, "PROPERTY ")
+        {
             return self.parse_procedure(line, line_num, ast);
         }
 
@@ -218,10 +274,9 @@ impl Vb6Parser {
         ast: &mut Vb6Ast,
     ) -> std::result::Result<(), ParseError> {
         // Basic parsing - extract visibility and variable info
-        let upper = line.to_uppercase();
-        let visibility = if upper.starts_with("PRIVATE") {
+        let visibility = if starts_with_ci(line, "PRIVATE") {
             Visibility::Private
-        } else if upper.starts_with("PUBLIC") || upper.starts_with("GLOBAL") {
+        } else if starts_with_ci(line, "PUBLIC") || starts_with_ci(line, "GLOBAL") {
             Visibility::Public
         } else {
             Visibility::Private // Dim defaults to private
@@ -231,7 +286,7 @@ impl Vb6Parser {
         // Format: [Visibility] Dim|Static VarName [As Type]
         let parts: Vec<&str> = line.split_whitespace().collect();
         if parts.len() >= 2 {
-            let name_part = if parts[0].to_uppercase() == "DIM" {
+            let name_part = if parts[0].eq_ignore_ascii_case("DIM") {
                 parts.get(1)
             } else {
                 parts.get(2)
@@ -262,10 +317,9 @@ impl Vb6Parser {
         ast: &mut Vb6Ast,
     ) -> std::result::Result<(), ParseError> {
         // Format: [Visibility] Const NAME = VALUE
-        let upper = line.to_uppercase();
-        let visibility = if upper.starts_with("PRIVATE") {
+        let visibility = if starts_with_ci(line, "PRIVATE") {
             Visibility::Private
-        } else if upper.starts_with("PUBLIC") {
+        } else if starts_with_ci(line, "PUBLIC") {
             Visibility::Public
         } else {
             Visibility::Private
@@ -295,15 +349,14 @@ impl Vb6Parser {
         line_num: usize,
         ast: &mut Vb6Ast,
     ) -> std::result::Result<(), ParseError> {
-        let upper = line.to_uppercase();
-        let visibility = if upper.starts_with("PRIVATE") {
+        let visibility = if starts_with_ci(line, "PRIVATE") {
             Visibility::Private
         } else {
             Visibility::Public
         };
 
         let parts: Vec<&str> = line.split_whitespace().collect();
-        if let Some(pos) = parts.iter().position(|p| p.to_uppercase() == "TYPE") {
+        if let Some(pos) = parts.iter().position(|p| p.eq_ignore_ascii_case("TYPE")) {
             if let Some(name) = parts.get(pos + 1) {
                 ast.add_user_type(UserType {
                     name: name.to_string(),
@@ -324,15 +377,14 @@ impl Vb6Parser {
         line_num: usize,
         ast: &mut Vb6Ast,
     ) -> std::result::Result<(), ParseError> {
-        let upper = line.to_uppercase();
-        let visibility = if upper.starts_with("PRIVATE") {
+        let visibility = if starts_with_ci(line, "PRIVATE") {
             Visibility::Private
         } else {
             Visibility::Public
         };
 
         let parts: Vec<&str> = line.split_whitespace().collect();
-        if let Some(pos) = parts.iter().position(|p| p.to_uppercase() == "ENUM") {
+        if let Some(pos) = parts.iter().position(|p| p.eq_ignore_ascii_case("ENUM")) {
             if let Some(name) = parts.get(pos + 1) {
                 ast.add_enum(Enumeration {
                     name: name.to_string(),
@@ -353,29 +405,27 @@ impl Vb6Parser {
         line_num: usize,
         ast: &mut Vb6Ast,
     ) -> std::result::Result<(), ParseError> {
-        let upper = line.to_uppercase();
-
         // Determine visibility
-        let visibility = if upper.starts_with("PRIVATE") {
+        let visibility = if starts_with_ci(line, "PRIVATE") {
             Visibility::Private
-        } else if upper.starts_with("PUBLIC") {
+        } else if starts_with_ci(line, "PUBLIC") {
             Visibility::Public
-        } else if upper.starts_with("FRIEND") {
+        } else if starts_with_ci(line, "FRIEND") {
             Visibility::Friend
         } else {
             Visibility::Public // Default for procedures
         };
 
         // Determine procedure type
-        let proc_type = if upper.contains(" SUB ") || upper.starts_with("SUB ") {
+        let proc_type = if contains_ci(line, " SUB ") || starts_with_ci(line, "SUB ") {
             ProcedureType::Sub
-        } else if upper.contains(" FUNCTION ") || upper.starts_with("FUNCTION ") {
+        } else if contains_ci(line, " FUNCTION ") || starts_with_ci(line, "FUNCTION ") {
             ProcedureType::Function
-        } else if upper.contains(" PROPERTY GET ") || upper.starts_with("PROPERTY GET ") {
+        } else if contains_ci(line, " PROPERTY GET ") || starts_with_ci(line, "PROPERTY GET ") {
             ProcedureType::PropertyGet
-        } else if upper.contains(" PROPERTY LET ") || upper.starts_with("PROPERTY LET ") {
+        } else if contains_ci(line, " PROPERTY LET ") || starts_with_ci(line, "PROPERTY LET ") {
             ProcedureType::PropertyLet
-        } else if upper.contains(" PROPERTY SET ") || upper.starts_with("PROPERTY SET ") {
+        } else if contains_ci(line, " PROPERTY SET ") || starts_with_ci(line, "PROPERTY SET ") {
             ProcedureType::PropertySet
         } else {
             ProcedureType::Sub
@@ -407,8 +457,7 @@ impl Vb6Parser {
 
     /// Extract type from "As Type" clause
     fn extract_type(&self, line: &str) -> Option<String> {
-        let upper = line.to_uppercase();
-        if let Some(pos) = upper.find(" AS ") {
+        if let Some(pos) = keywords::find_ci(line, " AS ") {
             let after_as = &line[pos + 4..];
             let type_name: String = after_as
                 .split(|c: char| !c.is_alphanumeric())
@@ -438,16 +487,17 @@ impl Vb6Parser {
                         continue;
                     }
 
-                    let upper = param.to_uppercase();
-                    let by_ref = !upper.starts_with("BYVAL");
-                    let optional = upper.contains("OPTIONAL");
+                    let by_ref = !starts_with_ci(param, "BYVAL");
+                    let optional = contains_ci(param, "OPTIONAL");
 
                     let parts: Vec<&str> = param.split_whitespace().collect();
                     let name = parts
                         .iter()
                         .find(|p| {
-                            let u = p.to_uppercase();
-                            u != "BYVAL" && u != "BYREF" && u != "OPTIONAL" && u != "AS"
+                            !p.eq_ignore_ascii_case("BYVAL")
+                                && !p.eq_ignore_ascii_case("BYREF")
+                                && !p.eq_ignore_ascii_case("OPTIONAL")
+                                && !p.eq_ignore_ascii_case("AS")
                         })
                         .map(|s| s.to_string())
                         .unwrap_or_default();
@@ -479,75 +529,135 @@ impl Vb6Parser {
         None
     }
 
-    /// Format VB6 source code
+    /// Format VB6 source code, emitting one edit per run of consecutive
+    /// changed lines so the client applies a minimal diff instead of a
+    /// per-line edit storm
     pub fn format(&self, source: &str) -> Option<Vec<TextEdit>> {
-        let mut edits = Vec::new();
-        let lines: Vec<&str> = source.lines().collect();
-        let mut indent_level: usize = 0;
+        self.format_lines(source, 0, usize::MAX)
+    }
 
-        for (line_num, line) in lines.iter().enumerate() {
-            let trimmed = line.trim();
-            let upper = trimmed.to_uppercase();
+    /// Format only the lines in `start_line..=end_line`. The indentation
+    /// context for the span comes from a state-only scan of the
+    /// preceding lines — no edits are produced outside the span, so the
+    /// cost of formatting a touched procedure is proportional to the
+    /// span plus one pass over the prefix, not to the whole file's edits.
+    pub fn format_range(
+        &self,
+        source: &str,
+        start_line: usize,
+        end_line: usize,
+    ) -> Option<Vec<TextEdit>> {
+        self.format_lines(source, start_line, end_line)
+    }
 
-            // Decrease indent before these keywords
-            if upper.starts_with("END ")
-                || upper == "END"
-                || upper.starts_with("ELSE")
-                || upper.starts_with("ELSEIF")
-                || upper.starts_with("CASE ")
-                || upper.starts_with("LOOP")
-                || upper.starts_with("NEXT")
-                || upper.starts_with("WEND")
-            {
-                indent_level = indent_level.saturating_sub(1);
-            }
+    fn format_lines(
+        &self,
+        source: &str,
+        start_line: usize,
+        end_line: usize,
+    ) -> Option<Vec<TextEdit>> {
+        let mut edits = Vec::new();
+        let mut indent_level: usize = 0;
 
-            // Calculate expected indentation
-            let expected_indent = "    ".repeat(indent_level);
-            let expected_line = format!("{}{}", expected_indent, trimmed);
+        // Consecutive changed lines accumulate into one replacement run
+        let mut run_start: Option<usize> = None;
+        let mut run_end = (0usize, 0usize); // (line, original line length)
+        let mut run_text = String::new();
 
-            // Create edit if line differs
-            if *line != expected_line && !trimmed.is_empty() {
+        let mut flush = |run_start: &mut Option<usize>,
+                         run_text: &mut String,
+                         run_end: (usize, usize),
+                         edits: &mut Vec<TextEdit>| {
+            if let Some(first_line) = run_start.take() {
                 edits.push(TextEdit {
                     range: Range {
                         start: Position {
-                            line: line_num as u32,
+                            line: first_line as u32,
                             character: 0,
                         },
                         end: Position {
-                            line: line_num as u32,
-                            character: line.len() as u32,
+                            line: run_end.0 as u32,
+                            character: run_end.1 as u32,
                         },
                     },
-                    new_text: expected_line,
+                    new_text: std::mem::take(run_text),
                 });
             }
+        };
+
+        for (line_num, line) in source.lines().enumerate() {
+            if line_num > end_line {
+                break;
+            }
+
+            let trimmed = line.trim();
+
+            // Decrease indent before these keywords
+            if starts_with_ci(trimmed, "END ")
+                || trimmed.eq_ignore_ascii_case("END")
+                || starts_with_ci(trimmed, "ELSE")
+                || starts_with_ci(trimmed, "ELSEIF")
+                || starts_with_ci(trimmed, "CASE ")
+                || starts_with_ci(trimmed, "LOOP")
+                || starts_with_ci(trimmed, "NEXT")
+                || starts_with_ci(trimmed, "WEND")
+            {
+                indent_level = indent_level.saturating_sub(1);
+            }
+
+            // Before the span only the indent state matters; inside it,
+            // changed lines extend the current run and unchanged lines
+            // close it
+            if line_num >= start_line {
+                let expected_indent = "    ".repeat(indent_level);
+                let changed = !trimmed.is_empty()
+                    && (line.len() != expected_indent.len() + trimmed.len()
+                        || !line.starts_with(&expected_indent)
+                        || !line.ends_with(trimmed));
+
+                if changed {
+                    if run_start.is_none() {
+                        run_start = Some(line_num);
+                    } else {
+                        run_text.push('\n');
+                    }
+                    run_text.push_str(&expected_indent);
+                    run_text.push_str(trimmed);
+                    run_end = (line_num, line.len());
+                } else {
+                    flush(&mut run_start, &mut run_text, run_end, &mut edits);
+                }
+            }
 
             // Increase indent after these keywords
-            if upper.starts_with("IF ") && upper.contains(" THEN") && !upper.contains(" THEN ")
-                || upper.starts_with("FOR ")
-                || upper.starts_with("DO ")
-                || upper.starts_with("DO")
-                || upper.starts_with("WHILE ")
-                || upper.starts_with("SELECT CASE")
-                || upper.starts_with("WITH ")
-                || upper.starts_with("SUB ")
-                || upper.starts_with("FUNCTION ")
-                || upper.starts_with("PROPERTY ")
-                || upper.starts_with("TYPE ")
-                || upper.starts_with("ENUM ")
-                || upper.starts_with("PRIVATE SUB ")
-                || upper.starts_with("PRIVATE FUNCTION ")
-                || upper.starts_with("PUBLIC SUB ")
-                || upper.starts_with("PUBLIC FUNCTION ")
-                || upper.starts_with("ELSE")
-                || upper.starts_with("ELSEIF")
-                || upper.starts_with("CASE ")
+            if starts_with_ci(trimmed, "IF ")
+                && contains_ci(trimmed, " THEN")
+                && !contains_ci(trimmed, " THEN ")
+                || starts_with_ci(trimmed, "FOR ")
+                || starts_with_ci(trimmed, "DO ")
+                || starts_with_ci(trimmed, "DO")
+                || starts_with_ci(trimmed, "WHILE ")
+                || starts_with_ci(trimmed, "SELECT CASE")
+                || starts_with_ci(trimmed, "WITH ")
+                || starts_with_ci(trimmed, "SUB ")
+                || starts_with_ci(trimmed, "FUNCTION ")
+                || starts_with_ci(trimmed, "PROPERTY ")
+                || starts_with_ci(trimmed, "TYPE ")
+                || starts_with_ci(trimmed, "ENUM ")
+                || starts_with_ci(trimmed, "PRIVATE SUB ")
+                || starts_with_ci(trimmed, "PRIVATE FUNCTION ")
+                || starts_with_ci(trimmed, "PUBLIC SUB ")
+                || starts_with_ci(trimmed, "PUBLIC FUNCTION ")
+                || starts_with_ci(trimmed, "ELSE")
+                || starts_with_ci(trimmed, "ELSEIF")
+                || starts_with_ci(trimmed, "CASE ")
             {
                 indent_level += 1;
             }
         }
 
+        flush(&mut run_start, &mut run_text, run_end, &mut edits);
+
         if edits.is_empty() {
             None
         } else {
@@ -593,6 +703,16 @@ End Function
         assert_eq!(ast.procedures.len(), 2);
     }
 
+    #[test]
+    fn test_parse_rope() {
+        let mut parser = Vb6Parser::new();
+        let rope = ropey::Rope::from_str("Dim x As Integer\nDim y As String\n");
+
+        let tree = parser.parse_rope(&rope);
+        assert!(tree.is_some());
+        assert_eq!(tree.unwrap().root_node().kind(), "source_file");
+    }
+
     #[test]
     fn test_incremental_parse() {
         let mut parser = Vb6Parser::new();
@@ -609,4 +729,41 @@ End Function
         let ast = result.unwrap();
         assert_eq!(ast.variables.len(), 2);
     }
+
+    #[test]
+    fn test_format_coalesces_adjacent_changes() {
+        let parser = Vb6Parser::new();
+        let source = "Sub Main()\nDim x As Integer\nDim y As Integer\nEnd Sub\n";
+
+        // Both misindented body lines land in a single replacement run
+        let edits = parser.format(source).expect("changes expected");
+        assert_eq!(edits.len(), 1);
+        assert_eq!(edits[0].range.start.line, 1);
+        assert_eq!(edits[0].range.end.line, 2);
+        assert_eq!(
+            edits[0].new_text,
+            "    Dim x As Integer\n    Dim y As Integer"
+        );
+    }
+
+    #[test]
+    fn test_format_already_formatted_is_none() {
+        let parser = Vb6Parser::new();
+        let source = "Sub Main()\n    Dim x As Integer\nEnd Sub\n";
+        assert!(parser.format(source).is_none());
+    }
+
+    #[test]
+    fn test_format_range_uses_preceding_context() {
+        let parser = Vb6Parser::new();
+        let source = "Sub First()\n    Dim a As Integer\nEnd Sub\n\nSub Second()\nDim b As Integer\nEnd Sub\n";
+
+        // Formatting only the second procedure still indents its body
+        // one level, and leaves everything outside the span alone
+        let edits = parser.format_range(source, 4, 6).expect("changes expected");
+        assert_eq!(edits.len(), 1);
+        assert_eq!(edits[0].range.start.line, 5);
+        assert_eq!(edits[0].range.end.line, 5);
+        assert_eq!(edits[0].new_text, "    Dim b As Integer");
+    }
 }
@@ -2,6 +2,9 @@
 //!
 //! Provides incremental parsing capabilities using the tree-sitter-vb6 grammar.
 
+use std::collections::HashMap;
+use std::sync::{Arc, Mutex};
+
 use tree_sitter::{Parser, Tree, Language, Query, QueryCursor};
 use streaming_iterator::StreamingIterator;
 
@@ -27,6 +30,25 @@ impl TreeSitterVb6Parser {
         self.parser.parse(source, old_tree)
     }
 
+    /// Parse VB6 source from a rope, optionally using a previous tree for
+    /// incremental parsing.
+    ///
+    /// Reads rope chunks in place rather than flattening the document into
+    /// a contiguous `String`, so large documents are parsed without an extra
+    /// full-text copy.
+    pub fn parse_rope(&mut self, rope: &ropey::Rope, old_tree: Option<&Tree>) -> Option<Tree> {
+        self.parser.parse_with(
+            &mut |byte, _point| {
+                if byte >= rope.len_bytes() {
+                    return &[] as &[u8];
+                }
+                let (chunk, chunk_start, _, _) = rope.chunk_at_byte(byte);
+                &chunk.as_bytes()[byte - chunk_start..]
+            },
+            old_tree,
+        )
+    }
+
     /// Get the tree-sitter language for queries
     pub fn language(&self) -> Language {
         tree_sitter_vb6::LANGUAGE.into()
@@ -42,18 +64,33 @@ impl Default for TreeSitterVb6Parser {
 /// Query helper for tree-sitter queries
 pub struct VB6QueryRunner {
     language: Language,
+    /// Compiled queries keyed by pattern text. Compiling a `Query`
+    /// walks the whole grammar, so each pattern compiles once per
+    /// runner and repeat callers share the result.
+    cache: Mutex<HashMap<String, Arc<Query>>>,
 }
 
 impl VB6QueryRunner {
     pub fn new() -> Self {
         Self {
             language: tree_sitter_vb6::LANGUAGE.into(),
+            cache: Mutex::new(HashMap::new()),
         }
     }
 
-    /// Create a query from a pattern string
-    pub fn create_query(&self, pattern: &str) -> Result<Query, tree_sitter::QueryError> {
-        Query::new(&self.language, pattern)
+    /// Create a query from a pattern string, reusing a previously
+    /// compiled query for the same pattern
+    pub fn create_query(&self, pattern: &str) -> Result<Arc<Query>, tree_sitter::QueryError> {
+        if let Some(query) = self.cache.lock().unwrap().get(pattern) {
+            return Ok(Arc::clone(query));
+        }
+
+        let query = Arc::new(Query::new(&self.language, pattern)?);
+        self.cache
+            .lock()
+            .unwrap()
+            .insert(pattern.to_string(), Arc::clone(&query));
+        Ok(query)
     }
 
     /// Run a query on a tree and return matches
@@ -115,6 +152,14 @@ mod tests {
         assert!(parser.is_ok());
     }
 
+    #[test]
+    fn test_query_cache_reuses_compiled_queries() {
+        let runner = VB6QueryRunner::new();
+        let first = runner.create_query("(identifier) @id").unwrap();
+        let second = runner.create_query("(identifier) @id").unwrap();
+        assert!(Arc::ptr_eq(&first, &second));
+    }
+
     #[test]
     fn test_basic_parse() {
         let mut parser = TreeSitterVb6Parser::new().unwrap();
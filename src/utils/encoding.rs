@@ -10,9 +10,10 @@
 //! 3. Preserve the original encoding for future writes
 
 use encoding_rs::{Encoding as EncodingRs, UTF_8, WINDOWS_1252};
+use std::borrow::Cow;
 use std::fs;
 use std::io;
-use std::path::Path;
+use std::path::{Path, PathBuf};
 use tracing::{debug, warn};
 
 /// Represents the detected or known encoding of a VB6 file
@@ -117,29 +118,44 @@ impl VB6FileReader {
     /// * `bytes` - Raw file bytes
     /// * `path` - File path (for logging only)
     pub fn detect_and_decode(bytes: &[u8], path: &Path) -> VB6FileContent {
-        // Check for UTF-8 BOM (EF BB BF)
-        let has_utf8_bom = bytes.starts_with(&[0xEF, 0xBB, 0xBF]);
+        let (text, encoding, had_errors) = Self::detect_and_decode_borrowed(bytes, path);
+        VB6FileContent {
+            text: text.into_owned(),
+            encoding,
+            had_errors,
+        }
+    }
 
-        if has_utf8_bom {
+    /// Detect encoding and decode bytes, borrowing when no conversion is
+    /// needed
+    ///
+    /// Same detection logic as `detect_and_decode`, but content that is
+    /// already valid UTF-8 (the common case: pure-ASCII VB6 source) comes
+    /// back as `Cow::Borrowed` over the input bytes instead of a fresh
+    /// `String`. Only genuine Windows-1252 content pays for a decode.
+    pub fn detect_and_decode_borrowed<'a>(
+        bytes: &'a [u8],
+        path: &Path,
+    ) -> (Cow<'a, str>, Encoding, bool) {
+        // Check for UTF-8 BOM (EF BB BF)
+        if let Some(rest) = bytes.strip_prefix(&[0xEF, 0xBB, 0xBF]) {
             debug!("File {} has UTF-8 BOM", path.display());
-            let text = String::from_utf8_lossy(&bytes[3..]).into_owned();
-            return VB6FileContent {
-                text,
-                encoding: Encoding::Utf8,
-                had_errors: false,
-            };
+            return (String::from_utf8_lossy(rest), Encoding::Utf8, false);
+        }
+
+        // ASCII fast path: `is_ascii` is a plain high-bit scan the
+        // compiler vectorizes, and ASCII bytes are valid UTF-8 as-is
+        // (`from_utf8` then only re-checks what we just proved)
+        if bytes.is_ascii() {
+            let text = std::str::from_utf8(bytes).expect("ASCII bytes are valid UTF-8");
+            return (Cow::Borrowed(text), Encoding::Utf8, false);
         }
 
-        // Try UTF-8 without BOM
-        match String::from_utf8(bytes.to_vec()) {
+        // Try UTF-8 without BOM (validation only, no copy)
+        match std::str::from_utf8(bytes) {
             Ok(text) => {
-                // Successfully decoded as UTF-8
                 debug!("File {} is valid UTF-8", path.display());
-                VB6FileContent {
-                    text,
-                    encoding: Encoding::Utf8,
-                    had_errors: false,
-                }
+                (Cow::Borrowed(text), Encoding::Utf8, false)
             }
             Err(_) => {
                 // Not valid UTF-8, try Windows-1252
@@ -147,31 +163,26 @@ impl VB6FileReader {
                     "File {} is not UTF-8, attempting Windows-1252 decode",
                     path.display()
                 );
-                Self::decode_windows1252(bytes, path)
+                let (decoded, _, had_errors) = WINDOWS_1252.decode(bytes);
+                if had_errors {
+                    warn!(
+                        "File {} had decoding errors when reading as Windows-1252",
+                        path.display()
+                    );
+                }
+                (decoded, Encoding::Windows1252, had_errors)
             }
         }
     }
 
-    /// Decode bytes as Windows-1252
+    /// Memory-map a VB6 file for decoding without an up-front read
     ///
-    /// Windows-1252 (CP1252) is the default encoding used by the VB6 IDE.
-    /// It's a superset of ISO-8859-1 (Latin-1) with additional characters
-    /// in the 0x80-0x9F range.
-    fn decode_windows1252(bytes: &[u8], path: &Path) -> VB6FileContent {
-        let (decoded, _, had_errors) = WINDOWS_1252.decode(bytes);
-
-        if had_errors {
-            warn!(
-                "File {} had decoding errors when reading as Windows-1252",
-                path.display()
-            );
-        }
-
-        VB6FileContent {
-            text: decoded.into_owned(),
-            encoding: Encoding::Windows1252,
-            had_errors,
-        }
+    /// Preferred over `read_file` for bulk work (workspace indexing):
+    /// the file's bytes are paged in by the OS as they are scanned, and
+    /// `MappedVB6File::decode` borrows straight from the mapping when no
+    /// conversion is needed.
+    pub fn open_mapped(path: &Path) -> io::Result<MappedVB6File> {
+        MappedVB6File::open(path)
     }
 
     /// Encode a string back to bytes using the specified encoding
@@ -205,8 +216,8 @@ impl VB6FileReader {
     ///
     /// Returns `true` if the bytes are likely Windows-1252.
     pub fn is_likely_windows1252(bytes: &[u8]) -> bool {
-        // If it's valid UTF-8, it's probably UTF-8
-        if String::from_utf8(bytes.to_vec()).is_ok() {
+        // If it's valid UTF-8, it's probably UTF-8 (validation only)
+        if std::str::from_utf8(bytes).is_ok() {
             return false;
         }
 
@@ -227,8 +238,8 @@ impl VB6FileReader {
             return Encoding::Utf8;
         }
 
-        // Try UTF-8 validation
-        if String::from_utf8(bytes.to_vec()).is_ok() {
+        // Try UTF-8 validation (no copy)
+        if std::str::from_utf8(bytes).is_ok() {
             return Encoding::Utf8;
         }
 
@@ -241,6 +252,48 @@ impl VB6FileReader {
     }
 }
 
+/// A VB6 source file backed by a memory mapping
+///
+/// Created by `VB6FileReader::open_mapped`. Holds the mapping open;
+/// `decode` yields text borrowing directly from it for UTF-8 content,
+/// so a pure-ASCII file is indexed without a single content copy.
+pub struct MappedVB6File {
+    path: PathBuf,
+    /// `None` for empty files (zero-length mappings are not portable)
+    map: Option<memmap2::Mmap>,
+}
+
+impl MappedVB6File {
+    /// Open and map a file
+    fn open(path: &Path) -> io::Result<Self> {
+        let file = fs::File::open(path)?;
+        let map = if file.metadata()?.len() == 0 {
+            None
+        } else {
+            // SAFETY: the mapping is read-only and private to this
+            // process. Truncation of the underlying file while mapped
+            // could fault, but we only map workspace sources we read
+            // anyway; the same race exists with `fs::read`.
+            Some(unsafe { memmap2::Mmap::map(&file)? })
+        };
+        Ok(Self {
+            path: path.to_path_buf(),
+            map,
+        })
+    }
+
+    /// The raw file bytes
+    pub fn bytes(&self) -> &[u8] {
+        self.map.as_deref().unwrap_or(&[])
+    }
+
+    /// Detect encoding and decode, borrowing from the mapping when the
+    /// content is already valid UTF-8
+    pub fn decode(&self) -> (Cow<'_, str>, Encoding, bool) {
+        VB6FileReader::detect_and_decode_borrowed(self.bytes(), &self.path)
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -306,6 +359,47 @@ mod tests {
         assert!(!had_errors);
     }
 
+    #[test]
+    fn test_borrowed_decode_ascii_fast_path() {
+        let bytes = b"Option Explicit\r\nDim x As Integer\r\n";
+        let (text, encoding, had_errors) =
+            VB6FileReader::detect_and_decode_borrowed(bytes, Path::new("test.bas"));
+
+        // ASCII content must come back without an allocation
+        assert!(matches!(text, Cow::Borrowed(_)));
+        assert_eq!(encoding, Encoding::Utf8);
+        assert!(!had_errors);
+
+        // Windows-1252 content still needs a real decode
+        let win1252 = vec![0x44, 0x69, 0x6D, 0x20, 0x93, 0x78, 0x94];
+        let (text, encoding, _) =
+            VB6FileReader::detect_and_decode_borrowed(&win1252, Path::new("test.bas"));
+        assert!(matches!(text, Cow::Owned(_)));
+        assert_eq!(encoding, Encoding::Windows1252);
+    }
+
+    #[test]
+    fn test_mapped_file_decode() {
+        let dir = std::env::temp_dir().join(format!("vb6-lsp-mmap-{}", std::process::id()));
+        fs::create_dir_all(&dir).unwrap();
+        let path = dir.join("Module1.bas");
+        fs::write(&path, "Public Sub Main()\r\nEnd Sub\r\n").unwrap();
+
+        let mapped = VB6FileReader::open_mapped(&path).unwrap();
+        let (text, encoding, had_errors) = mapped.decode();
+        assert_eq!(text, "Public Sub Main()\r\nEnd Sub\r\n");
+        assert_eq!(encoding, Encoding::Utf8);
+        assert!(!had_errors);
+
+        // Empty files map to empty text rather than an error
+        let empty = dir.join("Empty.bas");
+        fs::write(&empty, "").unwrap();
+        let mapped = VB6FileReader::open_mapped(&empty).unwrap();
+        assert_eq!(mapped.decode().0, "");
+
+        let _ = fs::remove_dir_all(&dir);
+    }
+
     #[test]
     fn test_is_likely_windows1252() {
         // UTF-8 text
@@ -1,5 +1,6 @@
 //! Utility modules for VB6 LSP
 
 pub mod encoding;
+pub mod perf;
 
-pub use encoding::{Encoding, VB6FileReader, VB6FileContent};
+pub use encoding::{Encoding, MappedVB6File, VB6FileReader, VB6FileContent};
@@ -0,0 +1,161 @@
+//! Hot-path latency instrumentation
+//!
+//! Lightweight global histograms keyed by stage name. Pipeline stages
+//! and LSP handlers record wall time (and optionally bytes processed)
+//! through RAII timers; `snapshot` aggregates everything into
+//! per-stage counts and percentiles for the `vb6/perfStats` request.
+//!
+//! Durations land in power-of-two microsecond buckets, so percentiles
+//! are upper bounds accurate to a factor of two — enough to spot a
+//! stage regressing from hundreds of microseconds to tens of
+//! milliseconds without any per-sample storage.
+
+use std::collections::HashMap;
+use std::sync::Mutex;
+use std::time::{Duration, Instant};
+
+use once_cell::sync::Lazy;
+
+/// Bucket `i` covers durations in `[2^i, 2^(i+1))` microseconds
+const BUCKET_COUNT: usize = 32;
+
+#[derive(Default)]
+struct StageStats {
+    count: u64,
+    total_nanos: u64,
+    max_nanos: u64,
+    bytes: u64,
+    buckets: [u64; BUCKET_COUNT],
+}
+
+static REGISTRY: Lazy<Mutex<HashMap<&'static str, StageStats>>> =
+    Lazy::new(|| Mutex::new(HashMap::new()));
+
+/// One stage's aggregated timings, as serialized into `vb6/perfStats`
+#[derive(Debug, Clone, serde::Serialize)]
+pub struct StageSnapshot {
+    pub stage: &'static str,
+    pub count: u64,
+    pub total_ms: f64,
+    pub mean_us: u64,
+    pub p50_us: u64,
+    pub p95_us: u64,
+    pub max_us: u64,
+    pub bytes_processed: u64,
+}
+
+/// Record one sample for a stage
+pub fn record(stage: &'static str, elapsed: Duration, bytes: u64) {
+    let nanos = elapsed.as_nanos() as u64;
+    let micros = elapsed.as_micros() as u64;
+    let bucket = (64 - micros.leading_zeros() as usize).min(BUCKET_COUNT - 1);
+
+    let mut registry = REGISTRY.lock().unwrap();
+    let stats = registry.entry(stage).or_default();
+    stats.count += 1;
+    stats.total_nanos += nanos;
+    stats.max_nanos = stats.max_nanos.max(nanos);
+    stats.bytes += bytes;
+    stats.buckets[bucket] += 1;
+}
+
+/// RAII timer; records the elapsed time for its stage when dropped
+pub struct StageTimer {
+    stage: &'static str,
+    bytes: u64,
+    start: Instant,
+}
+
+impl Drop for StageTimer {
+    fn drop(&mut self) {
+        record(self.stage, self.start.elapsed(), self.bytes);
+    }
+}
+
+/// Time a stage from now until the returned guard is dropped
+pub fn time(stage: &'static str) -> StageTimer {
+    time_bytes(stage, 0)
+}
+
+/// Like [`time`], also crediting `bytes` of input to the stage
+pub fn time_bytes(stage: &'static str, bytes: u64) -> StageTimer {
+    StageTimer {
+        stage,
+        bytes,
+        start: Instant::now(),
+    }
+}
+
+/// Snapshot all stages, sorted by name for stable output
+pub fn snapshot() -> Vec<StageSnapshot> {
+    let registry = REGISTRY.lock().unwrap();
+    let mut stages: Vec<StageSnapshot> = registry
+        .iter()
+        .map(|(stage, stats)| StageSnapshot {
+            stage,
+            count: stats.count,
+            total_ms: stats.total_nanos as f64 / 1_000_000.0,
+            mean_us: if stats.count == 0 {
+                0
+            } else {
+                stats.total_nanos / stats.count / 1_000
+            },
+            p50_us: percentile(stats, 0.50),
+            p95_us: percentile(stats, 0.95),
+            max_us: stats.max_nanos / 1_000,
+            bytes_processed: stats.bytes,
+        })
+        .collect();
+
+    stages.sort_by_key(|s| s.stage);
+    stages
+}
+
+/// Upper bound of the bucket holding the q-th sample
+fn percentile(stats: &StageStats, q: f64) -> u64 {
+    if stats.count == 0 {
+        return 0;
+    }
+
+    let rank = (stats.count as f64 * q).ceil() as u64;
+    let mut seen = 0u64;
+    for (i, &n) in stats.buckets.iter().enumerate() {
+        seen += n;
+        if seen >= rank {
+            // Bucket i covers [2^(i-1), 2^i) µs (bucket 0 is < 1 µs);
+            // cap at the observed max so outlier buckets do not inflate
+            return (1u64 << i).min(stats.max_nanos / 1_000).max(1);
+        }
+    }
+
+    stats.max_nanos / 1_000
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_record_and_snapshot() {
+        record("test.stage_a", Duration::from_micros(100), 4096);
+        record("test.stage_a", Duration::from_micros(200), 4096);
+        record("test.stage_a", Duration::from_millis(10), 4096);
+
+        let snap = snapshot();
+        let stage = snap.iter().find(|s| s.stage == "test.stage_a").unwrap();
+        assert_eq!(stage.count, 3);
+        assert_eq!(stage.bytes_processed, 3 * 4096);
+        assert!(stage.max_us >= 10_000);
+        assert!(stage.p50_us <= stage.p95_us);
+        assert!(stage.p95_us <= stage.max_us.next_power_of_two());
+    }
+
+    #[test]
+    fn test_timer_guard_records_on_drop() {
+        {
+            let _t = time("test.guarded");
+        }
+        let snap = snapshot();
+        assert!(snap.iter().any(|s| s.stage == "test.guarded" && s.count >= 1));
+    }
+}
@@ -22,6 +22,9 @@
 //! There is no overall file header - records are accessed by offset from the parent file.
 
 use std::io;
+use std::path::Path;
+
+use crate::utils::{MappedVB6File, VB6FileReader};
 
 /// Resolves a resource from a VB6 FRX file at the given offset.
 ///
@@ -97,6 +100,15 @@ pub fn resource_file_resolver(file_path: &str, offset: usize) -> Result<Vec<u8>,
         )
     })?;
 
+    resource_slice(&buffer, file_path, offset).map(|record| record.to_vec())
+}
+
+/// Locate the record at `offset` and return it as a slice of `buffer`
+///
+/// This is the record-type dispatch shared by `resource_file_resolver`
+/// (which copies the result) and `FrxFile::resource_at` (which hands the
+/// slice out straight from the mapping).
+fn resource_slice<'a>(buffer: &'a [u8], file_path: &str, offset: usize) -> io::Result<&'a [u8]> {
     // Validate offset
     if offset >= buffer.len() {
         return Err(io::Error::new(
@@ -110,34 +122,75 @@ pub fn resource_file_resolver(file_path: &str, offset: usize) -> Result<Vec<u8>,
     if buffer.len() >= offset + 12 {
         let signature = &buffer[offset + 4..offset + 8];
         if signature == b"lt\0\0" {
-            return parse_12_byte_header(&buffer, file_path, offset);
+            return parse_12_byte_header(buffer, file_path, offset);
         }
     }
 
     // Check for 16-bit record (starts with 0xFF)
     if buffer[offset] == 0xFF {
-        return parse_16bit_record(&buffer, file_path, offset);
+        return parse_16bit_record(buffer, file_path, offset);
     }
 
     // Check for list record
     if buffer.len() >= offset + 4 {
         let list_signature = &buffer[offset + 2..offset + 4];
         if list_signature == [0x03, 0x00] || list_signature == [0x07, 0x00] {
-            return parse_list_record(&buffer, file_path, offset);
+            return parse_list_record(buffer, file_path, offset);
         }
     }
 
     // Check for 4-byte header (contains null bytes)
     if buffer.len() >= offset + 12 && buffer[offset..offset + 4].contains(&0u8) {
-        return parse_4_byte_header(&buffer, file_path, offset);
+        return parse_4_byte_header(buffer, file_path, offset);
     }
 
     // Default: 8-bit record
-    parse_8bit_record(&buffer, file_path, offset)
+    parse_8bit_record(buffer, file_path, offset)
+}
+
+/// An FRX file opened once and memory-mapped for repeated lookups
+///
+/// Forms routinely reference many resources out of one FRX companion
+/// (and those can carry multi-megabyte image blobs); this keeps the
+/// mapping open and returns each record as a borrowed slice, so bytes
+/// are only paged in — never copied — when a resource is requested.
+///
+/// ```no_run
+/// use vb6_lsp::workspace::FrxFile;
+///
+/// let frx = FrxFile::open("MyForm.frx").unwrap();
+/// let icon = frx.resource_at(0x0C).unwrap();
+/// let list = frx.resource_at(0x24).unwrap();
+/// ```
+pub struct FrxFile {
+    path: String,
+    file: MappedVB6File,
+}
+
+impl FrxFile {
+    /// Open and map an FRX file
+    pub fn open(file_path: &str) -> io::Result<Self> {
+        let file = VB6FileReader::open_mapped(Path::new(file_path)).map_err(|err| {
+            io::Error::new(
+                io::ErrorKind::NotFound,
+                format!("Failed to map resource file {}: {}", file_path, err),
+            )
+        })?;
+        Ok(Self {
+            path: file_path.to_string(),
+            file,
+        })
+    }
+
+    /// The resource record at the given byte offset, borrowed from the
+    /// mapping (same record-format handling as `resource_file_resolver`)
+    pub fn resource_at(&self, offset: usize) -> io::Result<&[u8]> {
+        resource_slice(self.file.bytes(), &self.path, offset)
+    }
 }
 
 /// Parse a 12-byte header record with "lt\0\0" signature
-fn parse_12_byte_header(buffer: &[u8], file_path: &str, offset: usize) -> Result<Vec<u8>, io::Error> {
+fn parse_12_byte_header<'a>(buffer: &'a [u8], file_path: &str, offset: usize) -> io::Result<&'a [u8]> {
     let size_buffer = &buffer[offset..offset + 4];
     let buffer_size_1 = u32::from_le_bytes(
         size_buffer.try_into().map_err(|_| {
@@ -160,7 +213,7 @@ fn parse_12_byte_header(buffer: &[u8], file_path: &str, offset: usize) -> Result
 
     // Special case: empty record (e.g., removed icon)
     if buffer_size_1 == 8 && buffer_size_2 == 0 {
-        return Ok(vec![]);
+        return Ok(&[]);
     }
 
     // Validate size consistency
@@ -184,11 +237,11 @@ fn parse_12_byte_header(buffer: &[u8], file_path: &str, offset: usize) -> Result
         ));
     }
 
-    Ok(buffer[record_start..record_end].to_vec())
+    Ok(&buffer[record_start..record_end])
 }
 
 /// Parse a 16-bit record (starts with 0xFF)
-fn parse_16bit_record(buffer: &[u8], file_path: &str, offset: usize) -> Result<Vec<u8>, io::Error> {
+fn parse_16bit_record<'a>(buffer: &'a [u8], file_path: &str, offset: usize) -> io::Result<&'a [u8]> {
     let header_size_offset = offset + 1;
     let header_size_end = header_size_offset + 2;
 
@@ -233,11 +286,11 @@ fn parse_16bit_record(buffer: &[u8], file_path: &str, offset: usize) -> Result<V
         ));
     }
 
-    Ok(buffer[record_start..record_end].to_vec())
+    Ok(&buffer[record_start..record_end])
 }
 
 /// Parse a list record (list items)
-fn parse_list_record(buffer: &[u8], file_path: &str, offset: usize) -> Result<Vec<u8>, io::Error> {
+fn parse_list_record<'a>(buffer: &'a [u8], file_path: &str, offset: usize) -> io::Result<&'a [u8]> {
     let item_count_bytes = &buffer[offset..offset + 2];
     let list_item_count = u16::from_le_bytes(
         item_count_bytes.try_into().map_err(|_| {
@@ -280,11 +333,11 @@ fn parse_list_record(buffer: &[u8], file_path: &str, offset: usize) -> Result<Ve
         ));
     }
 
-    Ok(buffer[offset..record_offset].to_vec())
+    Ok(&buffer[offset..record_offset])
 }
 
 /// Parse a 4-byte header record
-fn parse_4_byte_header(buffer: &[u8], file_path: &str, offset: usize) -> Result<Vec<u8>, io::Error> {
+fn parse_4_byte_header<'a>(buffer: &'a [u8], file_path: &str, offset: usize) -> io::Result<&'a [u8]> {
     let size_bytes = &buffer[offset..offset + 4];
     let record_size = u32::from_le_bytes(
         size_bytes.try_into().map_err(|_| {
@@ -306,11 +359,11 @@ fn parse_4_byte_header(buffer: &[u8], file_path: &str, offset: usize) -> Result<
         ));
     }
 
-    Ok(buffer[record_start..record_end].to_vec())
+    Ok(&buffer[record_start..record_end])
 }
 
 /// Parse an 8-bit record (default/fallback)
-fn parse_8bit_record(buffer: &[u8], file_path: &str, offset: usize) -> Result<Vec<u8>, io::Error> {
+fn parse_8bit_record<'a>(buffer: &'a [u8], file_path: &str, offset: usize) -> io::Result<&'a [u8]> {
     let header_size = 1;
     let mut record_size = buffer[offset] as usize;
     let record_start = offset + header_size;
@@ -336,7 +389,7 @@ fn parse_8bit_record(buffer: &[u8], file_path: &str, offset: usize) -> Result<Ve
         ));
     }
 
-    Ok(buffer[record_start..record_end].to_vec())
+    Ok(&buffer[record_start..record_end])
 }
 
 /// Parses a list from FRX binary data.
@@ -519,6 +572,32 @@ mod tests {
         assert_eq!(result, vec![0x41, 0x42, 0x43]);
     }
 
+    #[test]
+    fn test_frx_file_lazy_access() {
+        let data = vec![
+            0xFF,                    // 16-bit record marker
+            0x05, 0x00,              // size = 5
+            0x41, 0x42, 0x43, 0x44, 0x45,  // "ABCDE"
+            0x03,                    // 8-bit record, size = 3
+            0x58, 0x59, 0x5A,        // "XYZ"
+        ];
+
+        let dir = std::env::temp_dir().join(format!("vb6-lsp-frx-{}", std::process::id()));
+        std::fs::create_dir_all(&dir).unwrap();
+        let path = dir.join("Test.frx");
+        std::fs::write(&path, &data).unwrap();
+
+        let frx = FrxFile::open(path.to_str().unwrap()).unwrap();
+
+        // Borrowed slices straight out of the mapping, one open for
+        // any number of lookups
+        assert_eq!(frx.resource_at(0).unwrap(), b"ABCDE");
+        assert_eq!(frx.resource_at(8).unwrap(), b"XYZ");
+        assert!(frx.resource_at(999).is_err());
+
+        let _ = std::fs::remove_dir_all(&dir);
+    }
+
     #[test]
     fn test_4byte_header() {
         // 4-byte header with 6 bytes of data
@@ -0,0 +1,206 @@
+//! Background Workspace Indexer
+//!
+//! Pre-parses every source file listed by the discovered VBP projects so
+//! cross-file navigation works right after startup instead of only for
+//! files the user has opened. Parsing and symbol table construction run
+//! on blocking worker threads; the LSP thread only takes short write
+//! locks to publish each finished table.
+
+use std::path::PathBuf;
+use std::sync::{Arc, RwLock};
+
+use ropey::Rope;
+use tokio::sync::mpsc;
+use tower_lsp::lsp_types::notification::Progress;
+use tower_lsp::lsp_types::request::WorkDoneProgressCreate;
+use tower_lsp::lsp_types::*;
+use tower_lsp::Client;
+
+use super::{SymbolCache, WorkspaceManager};
+use crate::analysis::{build_symbol_table, SymbolTable};
+use crate::parser::Vb6Parser;
+use crate::utils::VB6FileReader;
+
+/// Progress token used for the indexing work-done progress
+const PROGRESS_TOKEN: &str = "vb6-lsp/workspace-indexing";
+
+/// How many files to process between progress reports
+const PROGRESS_INTERVAL: usize = 25;
+
+/// Index every project member in the workspace in the background.
+///
+/// Spawned from `initialized`; fans the file list out over a pool of
+/// blocking workers and reports progress via `$/progress`.
+pub async fn index_workspace(client: Client, workspace: Arc<RwLock<WorkspaceManager>>) {
+    // Snapshot the file list under a short read lock; skip files that
+    // already have a symbol table (e.g. opened before indexing ran).
+    let files: Vec<PathBuf> = {
+        let ws = workspace.read().unwrap();
+        ws.projects()
+            .flat_map(|project| project.source_files())
+            .map(|member| member.absolute_path.clone())
+            .filter(|path| ws.get_symbol_table(path).is_none())
+            .collect()
+    };
+
+    if files.is_empty() {
+        return;
+    }
+
+    let total = files.len();
+    let progress = start_progress(&client, total).await;
+
+    // One blocking worker per core, each with its own parser, pulling
+    // file paths from a shared queue and sending finished tables back.
+    let worker_count = std::thread::available_parallelism()
+        .map(|n| n.get())
+        .unwrap_or(4)
+        .min(total);
+
+    let queue = Arc::new(std::sync::Mutex::new(files));
+    let cache = Arc::new(SymbolCache::open());
+    let (tx, mut rx) = mpsc::unbounded_channel::<(PathBuf, Option<SymbolTable>)>();
+
+    for _ in 0..worker_count {
+        let queue = Arc::clone(&queue);
+        let cache = Arc::clone(&cache);
+        let tx = tx.clone();
+        tokio::task::spawn_blocking(move || {
+            let mut parser = Vb6Parser::new();
+            loop {
+                let path = match queue.lock().unwrap().pop() {
+                    Some(path) => path,
+                    None => break,
+                };
+                let table = index_file(&mut parser, &cache, &path);
+                if tx.send((path, table)).is_err() {
+                    break;
+                }
+            }
+        });
+    }
+    drop(tx);
+
+    let mut indexed = 0usize;
+    let mut failed = 0usize;
+    while let Some((path, table)) = rx.recv().await {
+        match table {
+            Some(table) => {
+                let mut ws = workspace.write().unwrap();
+                // An open document may have produced a fresher table in
+                // the meantime; never overwrite it with the disk version.
+                if ws.get_symbol_table(&path).is_none() {
+                    ws.set_symbol_table(&path, table);
+                }
+            }
+            None => failed += 1,
+        }
+
+        indexed += 1;
+        if progress && (indexed % PROGRESS_INTERVAL == 0 || indexed == total) {
+            report_progress(&client, indexed, total).await;
+        }
+    }
+
+    if progress {
+        end_progress(&client, total, failed).await;
+    }
+
+    tracing::info!(
+        "Workspace indexing complete: {} files, {} failed",
+        total,
+        failed
+    );
+}
+
+/// Read, parse and build a symbol table for a single file, serving
+/// unchanged files from the persistent cache instead of re-parsing
+fn index_file(parser: &mut Vb6Parser, cache: &SymbolCache, path: &PathBuf) -> Option<SymbolTable> {
+    // Memory-map instead of fs::read: UTF-8 files (the common case) are
+    // then parsed straight out of the mapping without a content copy
+    let mapped = match VB6FileReader::open_mapped(path) {
+        Ok(mapped) => mapped,
+        Err(e) => {
+            tracing::warn!("Failed to read {}: {}", path.display(), e);
+            return None;
+        }
+    };
+    let (text, _, _) = mapped.decode();
+
+    // Cache hit: the file content matches a table from a previous run
+    if let Some(table) = cache.load(path, &text) {
+        return Some(table);
+    }
+
+    let uri = Url::from_file_path(path).ok()?;
+    let rope = Rope::from_str(&text);
+    let tree = parser.parse_rope(&rope)?;
+    // A fresh tree per file: drop the cached one so the next file
+    // doesn't get treated as an incremental parse.
+    parser.clear_cache();
+
+    let table = build_symbol_table(uri, &text, &tree);
+    cache.store(&text, &table);
+    Some(table)
+}
+
+/// Create and begin the work-done progress; returns false if the client
+/// rejected the token (progress reports are then skipped)
+async fn start_progress(client: &Client, total: usize) -> bool {
+    let token = NumberOrString::String(PROGRESS_TOKEN.to_string());
+    if client
+        .send_request::<WorkDoneProgressCreate>(WorkDoneProgressCreateParams {
+            token: token.clone(),
+        })
+        .await
+        .is_err()
+    {
+        return false;
+    }
+
+    client
+        .send_notification::<Progress>(ProgressParams {
+            token,
+            value: ProgressParamsValue::WorkDone(WorkDoneProgress::Begin(WorkDoneProgressBegin {
+                title: "Indexing VB6 workspace".to_string(),
+                message: Some(format!("0/{} files", total)),
+                percentage: Some(0),
+                cancellable: Some(false),
+            })),
+        })
+        .await;
+    true
+}
+
+/// Report intermediate indexing progress
+async fn report_progress(client: &Client, indexed: usize, total: usize) {
+    client
+        .send_notification::<Progress>(ProgressParams {
+            token: NumberOrString::String(PROGRESS_TOKEN.to_string()),
+            value: ProgressParamsValue::WorkDone(WorkDoneProgress::Report(
+                WorkDoneProgressReport {
+                    message: Some(format!("{}/{} files", indexed, total)),
+                    percentage: Some((indexed * 100 / total) as u32),
+                    cancellable: Some(false),
+                },
+            )),
+        })
+        .await;
+}
+
+/// Finish the work-done progress
+async fn end_progress(client: &Client, total: usize, failed: usize) {
+    let message = if failed == 0 {
+        format!("Indexed {} files", total)
+    } else {
+        format!("Indexed {} files ({} failed)", total, failed)
+    };
+    client
+        .send_notification::<Progress>(ProgressParams {
+            token: NumberOrString::String(PROGRESS_TOKEN.to_string()),
+            value: ProgressParamsValue::WorkDone(WorkDoneProgress::End(WorkDoneProgressEnd {
+                message: Some(message),
+            })),
+        })
+        .await;
+}
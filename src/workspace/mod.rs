@@ -3,25 +3,33 @@
 //! Handles multi-project workspaces with VBP discovery and cross-project navigation.
 
 mod frx_parser;
+mod indexer;
 mod project;
 mod res_parser;
+mod symbol_cache;
+mod symbol_index;
 mod vbp_parser;
 
-pub use frx_parser::{list_resolver, resource_file_resolver};
+pub use frx_parser::{list_resolver, resource_file_resolver, FrxFile};
+pub use indexer::index_workspace;
 pub use project::{ProjectStats, Vb6Project};
 pub use res_parser::{
-    create_string_table, parse_string_table, read_res_file, write_res_file, MemoryFlags,
-    ResHeader, ResourceEntry, ResourceId, ResourceType, StringTableEntry,
+    create_string_table, parse_string_table, read_res_file, write_res_file, LazyResFile,
+    LazyResourceEntry, MemoryFlags, ResHeader, ResourceEntry, ResourceId, ResourceType,
+    StringTableEntry,
 };
+pub use symbol_cache::SymbolCache;
+pub use symbol_index::{SymbolIndex, SymbolPosting};
 pub use vbp_parser::{
     ObjectReference, ProjectMember, ProjectType, TypeLibReference, VbpFile, VbpParseError,
 };
 
-use std::collections::HashMap;
+use std::collections::{HashMap, HashSet};
 use std::path::{Path, PathBuf};
+use std::sync::{Condvar, Mutex};
+use std::time::SystemTime;
 
 use tower_lsp::lsp_types::{Location, Url};
-use walkdir::WalkDir;
 
 use crate::analysis::{SymbolKind, SymbolTable};
 
@@ -39,6 +47,24 @@ pub struct WorkspaceManager {
 
     /// Files that don't belong to any VBP (orphans)
     orphan_files: HashMap<PathBuf, SymbolTable>,
+
+    /// Inverted index over all module-level symbols in the workspace,
+    /// maintained incrementally as symbol tables come and go
+    symbol_index: SymbolIndex,
+
+    /// Parsed VBP files keyed by path, revalidated by (mtime, size).
+    /// Entries survive project unloads on purpose: re-adding a root
+    /// re-loads hundreds of unchanged .vbp files, and the stamp check
+    /// keeps stale entries from ever being served.
+    vbp_cache: HashMap<PathBuf, CachedVbp>,
+}
+
+/// A cached VBP parse and the file stamp it was taken at
+#[derive(Debug)]
+struct CachedVbp {
+    mtime: SystemTime,
+    size: u64,
+    vbp: VbpFile,
 }
 
 impl WorkspaceManager {
@@ -49,6 +75,8 @@ impl WorkspaceManager {
             projects: HashMap::new(),
             file_to_project: HashMap::new(),
             orphan_files: HashMap::new(),
+            symbol_index: SymbolIndex::new(),
+            vbp_cache: HashMap::new(),
         }
     }
 
@@ -83,22 +111,11 @@ impl WorkspaceManager {
         }
     }
 
-    /// Scan a directory recursively for .vbp files
+    /// Scan a directory recursively for .vbp files, walking sibling
+    /// directories in parallel (a serial walk is painfully slow on
+    /// network shares, where each `read_dir` is a round trip)
     fn scan_for_vbp_files(&self, root: &Path) -> Vec<PathBuf> {
-        let mut vbp_files = Vec::new();
-
-        for entry in WalkDir::new(root)
-            .follow_links(true)
-            .into_iter()
-            .filter_map(|e| e.ok())
-        {
-            let path = entry.path();
-            if path.extension().map_or(false, |ext| {
-                ext.eq_ignore_ascii_case("vbp")
-            }) {
-                vbp_files.push(path.to_path_buf());
-            }
-        }
+        let vbp_files = scan_root_parallel(root);
 
         tracing::info!(
             "Discovered {} VBP files in {}",
@@ -111,7 +128,8 @@ impl WorkspaceManager {
 
     /// Load a VBP project
     pub fn load_project(&mut self, vbp_path: &Path) -> Result<(), VbpParseError> {
-        let project = Vb6Project::from_vbp(vbp_path)?;
+        let vbp = self.parse_vbp_cached(vbp_path)?;
+        let project = Vb6Project::from_parsed_vbp(vbp);
 
         // Build file-to-project index
         for member in project.source_files() {
@@ -130,13 +148,41 @@ impl WorkspaceManager {
         Ok(())
     }
 
+    /// Parse a VBP, serving an unchanged file from the in-memory cache
+    fn parse_vbp_cached(&mut self, vbp_path: &Path) -> Result<VbpFile, VbpParseError> {
+        let stamp = std::fs::metadata(vbp_path)
+            .ok()
+            .and_then(|meta| Some((meta.modified().ok()?, meta.len())));
+
+        if let (Some((mtime, size)), Some(cached)) = (stamp, self.vbp_cache.get(vbp_path)) {
+            if cached.mtime == mtime && cached.size == size {
+                tracing::debug!("VBP cache hit: {}", vbp_path.display());
+                return Ok(cached.vbp.clone());
+            }
+        }
+
+        let vbp = VbpFile::parse(vbp_path)?;
+        if let Some((mtime, size)) = stamp {
+            self.vbp_cache.insert(
+                vbp_path.to_path_buf(),
+                CachedVbp {
+                    mtime,
+                    size,
+                    vbp: vbp.clone(),
+                },
+            );
+        }
+        Ok(vbp)
+    }
+
     /// Unload a VBP project
     pub fn unload_project(&mut self, vbp_path: &Path) {
         if let Some(project) = self.projects.remove(vbp_path) {
-            // Remove from file-to-project index
+            // Remove from file-to-project and symbol indexes
             for member in project.source_files() {
                 let normalized = normalize_path(&member.absolute_path);
                 self.file_to_project.remove(&normalized);
+                self.symbol_index.remove_file(&normalized);
             }
 
             tracing::info!("Unloaded project '{}'", project.name());
@@ -170,6 +216,7 @@ impl WorkspaceManager {
     /// Store a symbol table for a file
     pub fn set_symbol_table(&mut self, file_path: &Path, table: SymbolTable) {
         let normalized = normalize_path(file_path);
+        self.symbol_index.add_file(&normalized, &table);
 
         if let Some(project) = self.project_for_file_mut(file_path) {
             project.set_symbol_table(normalized, table);
@@ -193,6 +240,7 @@ impl WorkspaceManager {
     /// Remove a symbol table
     pub fn remove_symbol_table(&mut self, file_path: &Path) {
         let normalized = normalize_path(file_path);
+        self.symbol_index.remove_file(&normalized);
 
         if let Some(project) = self.project_for_file_mut(file_path) {
             project.remove_symbol_table(&normalized);
@@ -202,56 +250,115 @@ impl WorkspaceManager {
     }
 
     /// Resolve a symbol across the workspace
-    /// First checks the current file's project, then other projects
+    /// Prefers the current file's project, then any other declaration
     pub fn resolve_symbol(&self, name: &str, from_file: &Path) -> Option<Location> {
-        // 1. Check current file's project first
+        // 1. Check if it's a module/class name reference in the current project
         if let Some(project) = self.project_for_file(from_file) {
-            // Check if it's a module/class name reference
             if let Some(location) = project.resolve_module_reference(name) {
                 return Some(location);
             }
-
-            // Check public symbols in the same project
-            if let Some(location) = project.find_public_symbol(name) {
-                return Some(location);
-            }
         }
 
-        // 2. Check other projects for public symbols
-        for project in self.projects.values() {
-            if let Some(location) = project.find_public_symbol(name) {
-                return Some(location);
+        // 2. Index lookup; prefer a declaration from the current file's project
+        let postings = self.symbol_index.lookup(name);
+        let current_vbp = self
+            .file_to_project
+            .get(&normalize_path(from_file))
+            .cloned();
+
+        let mut fallback = None;
+        for posting in postings {
+            if posting.visibility != crate::analysis::Visibility::Public {
+                continue;
+            }
+            let posting_vbp = self.file_to_project.get(posting.file.as_ref());
+            if posting_vbp == current_vbp.as_ref() {
+                return Some(posting.location.clone());
+            }
+            if fallback.is_none() {
+                fallback = Some(posting.location.clone());
             }
         }
 
-        // 3. Check orphan files
-        let name_lower = name.to_lowercase();
-        for table in self.orphan_files.values() {
-            if let Some(symbol) = table.lookup_symbol(&name_lower, table.module_scope) {
-                if symbol.visibility == crate::analysis::Visibility::Public {
-                    let range = symbol.name_range.to_lsp();
-                    return Some(Location {
-                        uri: table.uri.clone(),
-                        range,
-                    });
-                }
-            }
+        fallback
+    }
+
+    /// Find every reference to `name` across all loaded symbol tables.
+    ///
+    /// The defining module contributes its declaration and resolved
+    /// references; every other table contributes its recorded
+    /// unresolved uses of the name, which is exactly where calls to a
+    /// public symbol from another module land. `skip_file` omits a
+    /// table entirely, for callers that already collected its hits from
+    /// the live document. Tables are scanned in parallel.
+    pub fn find_references(
+        &self,
+        name: &str,
+        defining_file: &Path,
+        skip_file: Option<&Path>,
+    ) -> Vec<Location> {
+        let defining = normalize_path(defining_file);
+        let skip = skip_file.map(normalize_path);
+
+        let tables: Vec<(&PathBuf, &SymbolTable)> = self
+            .projects
+            .values()
+            .flat_map(|p| p.loaded_symbol_tables())
+            .chain(self.orphan_files.iter())
+            .filter(|(path, _)| skip.as_deref() != Some(path.as_path()))
+            .collect();
+
+        if tables.is_empty() {
+            return Vec::new();
         }
 
-        None
+        let worker_count = std::thread::available_parallelism()
+            .map(|n| n.get())
+            .unwrap_or(1)
+            .min(16)
+            .min(tables.len());
+        let chunk_size = tables.len().div_ceil(worker_count);
+
+        std::thread::scope(|scope| {
+            let workers: Vec<_> = tables
+                .chunks(chunk_size)
+                .map(|chunk| {
+                    let defining = defining.as_path();
+                    scope.spawn(move || {
+                        let mut found = Vec::new();
+                        for (path, table) in chunk {
+                            references_in_table(name, table, path.as_path() == defining, &mut found);
+                        }
+                        found
+                    })
+                })
+                .collect();
+
+            workers
+                .into_iter()
+                .flat_map(|w| w.join().unwrap_or_default())
+                .collect()
+        })
     }
 
     /// Find all public symbols matching a prefix (for workspace-wide completion)
     pub fn find_symbols_with_prefix(&self, prefix: &str) -> Vec<(String, PathBuf, SymbolKind)> {
-        let mut results = Vec::new();
-
-        for project in self.projects.values() {
-            for (name, path, kind) in project.find_public_symbols_with_prefix(prefix) {
-                results.push((name.to_string(), path.to_path_buf(), kind));
-            }
-        }
+        self.symbol_index
+            .prefix(prefix)
+            .filter(|posting| posting.visibility == crate::analysis::Visibility::Public)
+            .map(|posting| {
+                (
+                    posting.name.to_string(),
+                    posting.file.as_ref().clone(),
+                    posting.kind,
+                )
+            })
+            .collect()
+    }
 
-        results
+    /// The workspace-wide symbol index
+    pub fn symbol_index(&self) -> &SymbolIndex {
+        &self.symbol_index
     }
 
     /// Get all projects
@@ -281,6 +388,7 @@ impl WorkspaceManager {
             total_source_files: total_files,
             loaded_symbol_tables: loaded_tables,
             orphan_files: self.orphan_files.len(),
+            cached_vbp_files: self.vbp_cache.len(),
         }
     }
 }
@@ -292,13 +400,132 @@ impl Default for WorkspaceManager {
 }
 
 /// Workspace statistics
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, serde::Serialize)]
 pub struct WorkspaceStats {
     pub root_count: usize,
     pub project_count: usize,
     pub total_source_files: usize,
     pub loaded_symbol_tables: usize,
     pub orphan_files: usize,
+    /// Parsed .vbp files held by the stamp-checked parse cache
+    pub cached_vbp_files: usize,
+}
+
+/// Shared state of a parallel directory walk
+struct ScanState {
+    /// Directories waiting to be read
+    queue: Vec<PathBuf>,
+    /// Directories queued or currently being read; the walk is complete
+    /// when this reaches zero
+    pending: usize,
+    /// Discovered .vbp files
+    found: Vec<PathBuf>,
+    /// Canonical paths of directories already queued, so symlink cycles
+    /// terminate (links are followed, each real directory visited once)
+    visited: HashSet<PathBuf>,
+}
+
+/// Walk a root for .vbp files with a small pool of threads pulling
+/// directories from a shared queue. Each worker reads one directory per
+/// iteration and feeds its subdirectories back to the queue, so sibling
+/// subtrees are explored concurrently.
+fn scan_root_parallel(root: &Path) -> Vec<PathBuf> {
+    let worker_count = std::thread::available_parallelism()
+        .map(|n| n.get())
+        .unwrap_or(4)
+        // Beyond this the walk is bound by the filesystem, not by CPU
+        .min(16);
+
+    let mut visited = HashSet::new();
+    visited.insert(root.canonicalize().unwrap_or_else(|_| root.to_path_buf()));
+    let state = Mutex::new(ScanState {
+        queue: vec![root.to_path_buf()],
+        pending: 1,
+        found: Vec::new(),
+        visited,
+    });
+    let ready = Condvar::new();
+
+    std::thread::scope(|scope| {
+        for _ in 0..worker_count {
+            scope.spawn(|| loop {
+                let dir = {
+                    let mut guard = state.lock().unwrap();
+                    loop {
+                        if let Some(dir) = guard.queue.pop() {
+                            break dir;
+                        }
+                        if guard.pending == 0 {
+                            return;
+                        }
+                        guard = ready.wait(guard).unwrap();
+                    }
+                };
+
+                // Read the directory outside the lock
+                let mut subdirs = Vec::new();
+                let mut vbps = Vec::new();
+                if let Ok(entries) = std::fs::read_dir(&dir) {
+                    for entry in entries.filter_map(|e| e.ok()) {
+                        let path = entry.path();
+                        if path.is_dir() {
+                            subdirs.push(path);
+                        } else if path
+                            .extension()
+                            .map_or(false, |ext| ext.eq_ignore_ascii_case("vbp"))
+                        {
+                            vbps.push(path);
+                        }
+                    }
+                }
+
+                let mut guard = state.lock().unwrap();
+                guard.found.append(&mut vbps);
+                for sub in subdirs {
+                    let canonical = sub.canonicalize().unwrap_or_else(|_| sub.clone());
+                    if guard.visited.insert(canonical) {
+                        guard.queue.push(sub);
+                        guard.pending += 1;
+                    }
+                }
+                guard.pending -= 1;
+                // Wake waiters when new work arrived or the walk finished
+                ready.notify_all();
+            });
+        }
+    });
+
+    let mut found = state.into_inner().unwrap().found;
+    // Deterministic order regardless of which worker found what first
+    found.sort();
+    found
+}
+
+/// Collect one table's references to `name` into `found`: the
+/// declaration and resolved references when the table is the defining
+/// module, recorded unresolved uses otherwise.
+fn references_in_table(name: &str, table: &SymbolTable, is_defining: bool, found: &mut Vec<Location>) {
+    if is_defining {
+        if let Some(symbol) = table.lookup_symbol(name, table.module_scope) {
+            found.push(Location {
+                uri: table.uri.clone(),
+                range: symbol.name_range.to_lsp(),
+            });
+            for reference in table.get_references(symbol.id) {
+                found.push(Location {
+                    uri: table.uri.clone(),
+                    range: reference.range.to_lsp(),
+                });
+            }
+        }
+    } else {
+        for unresolved in table.unresolved_named(name) {
+            found.push(Location {
+                uri: table.uri.clone(),
+                range: unresolved.range.to_lsp(),
+            });
+        }
+    }
 }
 
 /// Normalize a path for comparison (lowercase on Windows)
@@ -325,4 +552,47 @@ mod tests {
         let manager = WorkspaceManager::new();
         assert_eq!(manager.projects().count(), 0);
     }
+
+    #[test]
+    fn test_find_references_across_files() {
+        use crate::analysis::build_symbol_table;
+        use crate::parser::TreeSitterVb6Parser;
+
+        let mut parser = TreeSitterVb6Parser::new().unwrap();
+        let mut table_for = |path: &str, source: &str| {
+            let tree = parser.parse(source, None).unwrap();
+            let uri = Url::from_file_path(path).unwrap();
+            build_symbol_table(uri, source, &tree)
+        };
+
+        // Defining module declares and calls SharedProc; the other
+        // module only calls it, so its use is recorded as unresolved
+        let defining = table_for(
+            "/ws/moda.bas",
+            "Public Sub SharedProc()\nEnd Sub\n\nSub Caller()\n    SharedProc\nEnd Sub\n",
+        );
+        let user = table_for(
+            "/ws/modb.bas",
+            "Sub OtherCaller()\n    SharedProc\nEnd Sub\n",
+        );
+
+        let mut manager = WorkspaceManager::new();
+        manager.set_symbol_table(Path::new("/ws/moda.bas"), defining);
+        manager.set_symbol_table(Path::new("/ws/modb.bas"), user);
+
+        let locations = manager.find_references("SharedProc", Path::new("/ws/moda.bas"), None);
+
+        // Declaration + local call in moda, unresolved call in modb
+        assert!(locations.len() >= 3);
+        assert!(locations.iter().any(|l| l.uri.path().ends_with("modb.bas")));
+
+        // Skipping the defining file leaves only the other module's use
+        let skipped = manager.find_references(
+            "SharedProc",
+            Path::new("/ws/moda.bas"),
+            Some(Path::new("/ws/moda.bas")),
+        );
+        assert!(skipped.iter().all(|l| l.uri.path().ends_with("modb.bas")));
+        assert!(!skipped.is_empty());
+    }
 }
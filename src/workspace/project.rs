@@ -7,7 +7,7 @@ use std::path::{Path, PathBuf};
 
 use tower_lsp::lsp_types::{Location, Url};
 
-use crate::analysis::{SymbolKind, SymbolTable, Visibility};
+use crate::analysis::{Name, SymbolKind, SymbolTable, Visibility};
 
 use super::vbp_parser::{ProjectMember, VbpFile, VbpParseError};
 
@@ -20,9 +20,9 @@ pub struct Vb6Project {
     /// Symbol tables for each file (keyed by absolute path)
     symbol_tables: HashMap<PathBuf, SymbolTable>,
 
-    /// Index of public symbols: lowercase name -> (file_path, symbol_name)
+    /// Index of public symbols: lowercase name -> (file_path, interned symbol name)
     /// This is rebuilt when symbol tables change
-    public_symbol_index: HashMap<String, Vec<(PathBuf, String)>>,
+    public_symbol_index: HashMap<String, Vec<(PathBuf, Name)>>,
 }
 
 impl Vb6Project {
@@ -87,6 +87,11 @@ impl Vb6Project {
         self.symbol_tables.get(file_path)
     }
 
+    /// All loaded symbol tables in this project
+    pub fn loaded_symbol_tables(&self) -> impl Iterator<Item = (&PathBuf, &SymbolTable)> {
+        self.symbol_tables.iter()
+    }
+
     /// Remove a symbol table (when file is closed or deleted)
     pub fn remove_symbol_table(&mut self, file_path: &Path) {
         self.symbol_tables.remove(file_path);
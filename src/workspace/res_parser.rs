@@ -40,9 +40,12 @@
 //! write_res_file("output.res", &resources)?;
 //! ```
 
-use std::io::{self, Read, Write, Cursor, Seek};
+use std::io::{self, Read, Write, Cursor, Seek, SeekFrom};
+use std::path::Path;
 use byteorder::{LittleEndian, ReadBytesExt, WriteBytesExt};
 
+use crate::utils::{MappedVB6File, VB6FileReader};
+
 /// Standard Win32 resource types
 #[derive(Debug, Clone, PartialEq, Eq)]
 pub enum ResourceType {
@@ -496,6 +499,104 @@ pub fn read_res_file(file_path: &str) -> io::Result<Vec<ResourceEntry>> {
     Ok(entries)
 }
 
+/// A .res file opened lazily over a memory mapping
+///
+/// `read_res_file` copies every payload into owned buffers, which is
+/// wasteful when a query only needs headers (or one resource out of
+/// many). This variant parses just the headers into an index of
+/// (type, id, offset, length) records and leaves payload bytes in the
+/// mapping; `data` returns a borrowed slice, paged in on first touch.
+///
+/// ```no_run
+/// use vb6_lsp::workspace::{LazyResFile, ResourceId, ResourceType};
+///
+///
+/// let res = LazyResFile::open("myproject.res")?;
+/// if let Some(entry) = res.find(&ResourceType::String, &ResourceId::Id(1)) {
+///     let bytes = res.data(entry)?; // only now are the bytes touched
+/// }
+/// # std::io::Result::Ok(())
+/// ```
+pub struct LazyResFile {
+    file: MappedVB6File,
+    index: Vec<LazyResourceEntry>,
+}
+
+/// Index record for one resource in a lazily opened .res file
+#[derive(Debug, Clone)]
+pub struct LazyResourceEntry {
+    /// The parsed resource header (type, id, language, flags, sizes)
+    pub header: ResHeader,
+    /// Byte offset of the payload within the file
+    pub offset: usize,
+    /// Payload length in bytes (same as `header.data_size`)
+    pub length: usize,
+}
+
+impl LazyResFile {
+    /// Open a .res file and index its headers without reading payloads
+    pub fn open(file_path: &str) -> io::Result<Self> {
+        let file = VB6FileReader::open_mapped(Path::new(file_path))?;
+
+        let mut index = Vec::new();
+        {
+            let mut cursor = Cursor::new(file.bytes());
+            loop {
+                let header = match ResHeader::read_from(&mut cursor) {
+                    Ok(h) => h,
+                    Err(e) if e.kind() == io::ErrorKind::UnexpectedEof => break,
+                    Err(e) => return Err(e),
+                };
+
+                let offset = cursor.position() as usize;
+                let length = header.data_size as usize;
+
+                // Skip over the payload instead of reading it
+                cursor.seek(SeekFrom::Current(length as i64))?;
+                align_reader_to_dword(&mut cursor)?;
+
+                // Skip empty headers (first record in file)
+                if header.data_size == 0 && index.is_empty() {
+                    continue;
+                }
+
+                index.push(LazyResourceEntry { header, offset, length });
+            }
+        }
+
+        Ok(Self { file, index })
+    }
+
+    /// All indexed resources, in file order
+    pub fn entries(&self) -> &[LazyResourceEntry] {
+        &self.index
+    }
+
+    /// Find a resource by type and name/ID
+    pub fn find(&self, resource_type: &ResourceType, name: &ResourceId) -> Option<&LazyResourceEntry> {
+        self.index
+            .iter()
+            .find(|entry| entry.header.resource_type == *resource_type && entry.header.name == *name)
+    }
+
+    /// The payload bytes for an entry, borrowed from the mapping
+    pub fn data(&self, entry: &LazyResourceEntry) -> io::Result<&[u8]> {
+        let end = entry.offset.checked_add(entry.length);
+        match end {
+            Some(end) if end <= self.file.bytes().len() => {
+                Ok(&self.file.bytes()[entry.offset..end])
+            }
+            _ => Err(io::Error::new(
+                io::ErrorKind::InvalidData,
+                format!(
+                    "Resource data at offset {} (length {}) is out of bounds",
+                    entry.offset, entry.length
+                ),
+            )),
+        }
+    }
+}
+
 /// Write resource entries to a .res file
 ///
 /// # Arguments
@@ -895,4 +996,44 @@ mod tests {
         // Clean up
         let _ = std::fs::remove_file(temp_path);
     }
+
+    #[test]
+    fn test_lazy_res_file() {
+        let entries = vec![
+            ResourceEntry::new(
+                ResourceType::String,
+                ResourceId::Id(1),
+                0x0409,
+                vec![1, 2, 3, 4],
+            ),
+            ResourceEntry::new(
+                ResourceType::Bitmap,
+                ResourceId::Id(100),
+                0x0409,
+                vec![5, 6, 7, 8, 9],
+            ),
+        ];
+
+        let temp_path = "test_lazy_output.res";
+        write_res_file(temp_path, &entries).unwrap();
+
+        let lazy = LazyResFile::open(temp_path).unwrap();
+        assert_eq!(lazy.entries().len(), 2);
+
+        // The index carries type/id/length without touching payloads
+        let bitmap = lazy
+            .find(&ResourceType::Bitmap, &ResourceId::Id(100))
+            .unwrap();
+        assert_eq!(bitmap.length, 5);
+
+        // Payload bytes come straight from the mapping
+        assert_eq!(lazy.data(bitmap).unwrap(), &[5, 6, 7, 8, 9]);
+
+        let string = lazy
+            .find(&ResourceType::String, &ResourceId::Id(1))
+            .unwrap();
+        assert_eq!(lazy.data(string).unwrap(), &[1, 2, 3, 4]);
+
+        let _ = std::fs::remove_file(temp_path);
+    }
 }
@@ -0,0 +1,166 @@
+//! Persistent Symbol Cache
+//!
+//! Stores serialized symbol tables on disk, keyed by a hash of the file
+//! content, so a workspace that has not changed since the last session
+//! becomes navigable without re-parsing every member file. Entries whose
+//! content hash no longer matches are simply missed and the file is
+//! re-indexed as usual; the cache format version is folded into the key,
+//! so a format change invalidates all old entries at once.
+
+use std::fs;
+use std::path::{Path, PathBuf};
+
+use tower_lsp::lsp_types::Url;
+
+use crate::analysis::SymbolTable;
+
+/// Bumped whenever the serialized `SymbolTable` layout changes; folded
+/// into every cache key so stale-format entries become misses.
+const CACHE_FORMAT_VERSION: u64 = 2; // v2: unresolved references added to SymbolTable
+
+/// Environment variable overriding the cache directory
+const CACHE_DIR_ENV: &str = "VB6_LSP_CACHE_DIR";
+
+/// On-disk cache of serialized symbol tables
+pub struct SymbolCache {
+    /// Directory holding one `.bin` file per cached table; `None` if the
+    /// directory could not be created (caching is then disabled)
+    dir: Option<PathBuf>,
+}
+
+impl SymbolCache {
+    /// Open (creating if needed) the cache directory. Respects
+    /// `VB6_LSP_CACHE_DIR`; defaults to a `vb6-lsp` subdirectory of the
+    /// system temp directory. Failure to create the directory disables
+    /// the cache rather than failing indexing.
+    pub fn open() -> Self {
+        let dir = std::env::var_os(CACHE_DIR_ENV)
+            .map(PathBuf::from)
+            .unwrap_or_else(|| std::env::temp_dir().join("vb6-lsp").join("symbol-cache"));
+
+        match fs::create_dir_all(&dir) {
+            Ok(()) => Self { dir: Some(dir) },
+            Err(e) => {
+                tracing::warn!("Symbol cache disabled ({}): {}", dir.display(), e);
+                Self { dir: None }
+            }
+        }
+    }
+
+    /// Load a cached symbol table for a file with the given content.
+    /// Returns `None` on any miss or error — the caller re-indexes from
+    /// source, which also repairs corrupt entries on the next store.
+    pub fn load(&self, path: &Path, content: &str) -> Option<SymbolTable> {
+        let entry = self.entry_path(content)?;
+        let bytes = fs::read(&entry).ok()?;
+
+        let mut table: SymbolTable = match bincode::deserialize(&bytes) {
+            Ok(table) => table,
+            Err(e) => {
+                tracing::warn!("Discarding corrupt cache entry {}: {}", entry.display(), e);
+                let _ = fs::remove_file(&entry);
+                return None;
+            }
+        };
+
+        // Identical content may live at a different path than when the
+        // entry was written (copied projects); trust the caller's path.
+        table.uri = Url::from_file_path(path).ok()?;
+        table.rehydrate();
+        Some(table)
+    }
+
+    /// Store a symbol table for a file with the given content. Errors are
+    /// logged and ignored — the cache is purely an accelerator.
+    pub fn store(&self, content: &str, table: &SymbolTable) {
+        let Some(entry) = self.entry_path(content) else {
+            return;
+        };
+
+        let bytes = match bincode::serialize(table) {
+            Ok(bytes) => bytes,
+            Err(e) => {
+                tracing::warn!("Failed to serialize symbol table for cache: {}", e);
+                return;
+            }
+        };
+
+        // Write via a temp file so readers never observe a partial entry
+        let tmp = entry.with_extension("tmp");
+        if let Err(e) = fs::write(&tmp, &bytes).and_then(|_| fs::rename(&tmp, &entry)) {
+            tracing::warn!("Failed to write cache entry {}: {}", entry.display(), e);
+            let _ = fs::remove_file(&tmp);
+        }
+    }
+
+    /// Path of the cache entry for the given content, or `None` when the
+    /// cache is disabled
+    fn entry_path(&self, content: &str) -> Option<PathBuf> {
+        let dir = self.dir.as_ref()?;
+        Some(dir.join(format!("{:016x}.bin", content_key(content))))
+    }
+}
+
+/// FNV-1a hash of the content, seeded with the cache format version
+fn content_key(content: &str) -> u64 {
+    let mut hash: u64 = 0xcbf29ce484222325 ^ CACHE_FORMAT_VERSION;
+    for byte in content.as_bytes() {
+        hash ^= u64::from(*byte);
+        hash = hash.wrapping_mul(0x100000001b3);
+    }
+    hash
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::analysis::{SourcePosition, SourceRange, SymbolKind, Visibility};
+
+    fn cache_in_temp_dir(tag: &str) -> SymbolCache {
+        let dir = std::env::temp_dir()
+            .join("vb6-lsp-test-cache")
+            .join(format!("{}-{}", tag, std::process::id()));
+        let _ = fs::remove_dir_all(&dir);
+        fs::create_dir_all(&dir).unwrap();
+        SymbolCache { dir: Some(dir) }
+    }
+
+    #[test]
+    fn test_cache_round_trip() {
+        let cache = cache_in_temp_dir("round-trip");
+        let path = Path::new("/tmp/Module1.bas");
+        let content = "Public Sub Main()\nEnd Sub\n";
+
+        let mut table = SymbolTable::new(Url::parse("file:///tmp/Module1.bas").unwrap());
+        table.create_symbol(
+            "Main",
+            SymbolKind::Sub,
+            Visibility::Public,
+            SourceRange::new(SourcePosition::new(0, 0), SourcePosition::new(1, 7)),
+            SourceRange::new(SourcePosition::new(0, 11), SourcePosition::new(0, 15)),
+            table.module_scope,
+        );
+
+        assert!(cache.load(path, content).is_none());
+        cache.store(content, &table);
+
+        let loaded = cache.load(path, content).expect("cache hit after store");
+        let symbol = loaded
+            .lookup_symbol("main", loaded.module_scope)
+            .expect("symbol resolvable after rehydration");
+        assert_eq!(symbol.name, "Main");
+        assert_eq!(symbol.kind, SymbolKind::Sub);
+    }
+
+    #[test]
+    fn test_changed_content_misses() {
+        let cache = cache_in_temp_dir("changed-content");
+        let path = Path::new("/tmp/Module1.bas");
+
+        let table = SymbolTable::new(Url::parse("file:///tmp/Module1.bas").unwrap());
+        cache.store("Dim a As Integer\n", &table);
+
+        assert!(cache.load(path, "Dim a As Long\n").is_none());
+        assert!(cache.load(path, "Dim a As Integer\n").is_some());
+    }
+}
@@ -0,0 +1,273 @@
+//! Workspace Symbol Index
+//!
+//! An inverted index over all module-level symbols in the workspace.
+//! Case-folded names map to postings of (file, symbol id, location), so
+//! `resolve_symbol` and prefix completion are index lookups instead of
+//! scans over every stored symbol table. Names and paths are interned
+//! as `Arc`s so postings and per-file bookkeeping share one allocation.
+
+use std::collections::{BTreeMap, HashMap};
+use std::path::{Path, PathBuf};
+use std::sync::Arc;
+
+use tower_lsp::lsp_types::Location;
+
+use crate::analysis::{SymbolId, SymbolKind, SymbolTable, Visibility};
+
+/// A single indexed symbol occurrence
+#[derive(Debug, Clone)]
+pub struct SymbolPosting {
+    /// Original-case symbol name
+    pub name: Arc<str>,
+    /// File that declares the symbol
+    pub file: Arc<PathBuf>,
+    /// Id of the symbol within its file's table
+    pub symbol_id: SymbolId,
+    /// Symbol kind (for completion item kinds)
+    pub kind: SymbolKind,
+    /// Declared visibility
+    pub visibility: Visibility,
+    /// Location of the symbol's name for go-to-definition
+    pub location: Location,
+}
+
+/// Inverted index: case-folded name -> postings
+///
+/// Backed by a `BTreeMap` so prefix queries are a bounded range walk
+/// over the sorted keys.
+#[derive(Debug, Default)]
+pub struct SymbolIndex {
+    /// Case-folded name -> all declarations of that name
+    postings: BTreeMap<Arc<str>, Vec<SymbolPosting>>,
+    /// Per-file list of folded names contributed, so a file's entries
+    /// can be removed without walking the whole index
+    file_names: HashMap<Arc<PathBuf>, Vec<Arc<str>>>,
+}
+
+impl SymbolIndex {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Index all module-level symbols of a file, replacing any previous
+    /// entries for that file
+    pub fn add_file(&mut self, path: &Path, table: &SymbolTable) {
+        self.remove_file(path);
+
+        let file: Arc<PathBuf> = Arc::new(path.to_path_buf());
+        let mut names = Vec::new();
+
+        for symbol in table.module_symbols() {
+            let key: Arc<str> = Arc::from(symbol.name.to_lowercase().as_str());
+            let posting = SymbolPosting {
+                name: Arc::clone(symbol.name.as_arc()),
+                file: Arc::clone(&file),
+                symbol_id: symbol.id,
+                kind: symbol.kind,
+                visibility: symbol.visibility,
+                location: Location {
+                    uri: table.uri.clone(),
+                    range: symbol.name_range.to_lsp(),
+                },
+            };
+
+            self.postings
+                .entry(Arc::clone(&key))
+                .or_default()
+                .push(posting);
+            names.push(key);
+        }
+
+        if !names.is_empty() {
+            self.file_names.insert(file, names);
+        }
+    }
+
+    /// Remove all entries contributed by a file
+    pub fn remove_file(&mut self, path: &Path) {
+        let key = path.to_path_buf();
+        let Some(names) = self.file_names.remove(&key) else {
+            return;
+        };
+
+        for name in names {
+            if let Some(postings) = self.postings.get_mut(&name) {
+                postings.retain(|p| *p.file != key);
+                if postings.is_empty() {
+                    self.postings.remove(&name);
+                }
+            }
+        }
+    }
+
+    /// Exact lookup by name (case-insensitive)
+    pub fn lookup(&self, name: &str) -> &[SymbolPosting] {
+        self.postings
+            .get(name.to_lowercase().as_str())
+            .map(Vec::as_slice)
+            .unwrap_or(&[])
+    }
+
+    /// All postings whose folded name starts with the given prefix
+    /// (case-insensitive), in sorted name order
+    pub fn prefix(&self, prefix: &str) -> impl Iterator<Item = &SymbolPosting> {
+        let prefix = prefix.to_lowercase();
+        self.postings
+            .range(Arc::<str>::from(prefix.as_str())..)
+            .take_while(move |(name, _)| name.starts_with(&prefix))
+            .flat_map(|(_, postings)| postings.iter())
+    }
+
+    /// Ranked fuzzy query over all indexed names (for workspace/symbol).
+    ///
+    /// Matches exact names, prefixes, substrings and in-order character
+    /// subsequences, in that score order, and returns at most `limit`
+    /// postings. An empty query returns the first `limit` postings in
+    /// name order.
+    pub fn query(&self, query: &str, limit: usize) -> Vec<&SymbolPosting> {
+        if query.is_empty() {
+            return self
+                .postings
+                .values()
+                .flat_map(|postings| postings.iter())
+                .take(limit)
+                .collect();
+        }
+
+        let query = query.to_lowercase();
+        let mut scored: Vec<(u32, &Arc<str>, &Vec<SymbolPosting>)> = self
+            .postings
+            .iter()
+            .filter_map(|(name, postings)| {
+                match_score(name, &query).map(|score| (score, name, postings))
+            })
+            .collect();
+
+        // Best score first; ties break alphabetically (BTreeMap iteration
+        // order is already sorted, and the sort is stable)
+        scored.sort_by_key(|(score, _, _)| std::cmp::Reverse(*score));
+
+        scored
+            .into_iter()
+            .flat_map(|(_, _, postings)| postings.iter())
+            .take(limit)
+            .collect()
+    }
+
+    /// Number of distinct indexed names
+    pub fn name_count(&self) -> usize {
+        self.postings.len()
+    }
+
+    /// Number of files with indexed entries
+    pub fn file_count(&self) -> usize {
+        self.file_names.len()
+    }
+}
+
+/// Score a case-folded name against a case-folded query.
+/// Higher is better; `None` means no match.
+fn match_score(name: &str, query: &str) -> Option<u32> {
+    if name == query {
+        return Some(400);
+    }
+    if name.starts_with(query) {
+        return Some(300);
+    }
+    if name.contains(query) {
+        return Some(200);
+    }
+
+    // In-order character subsequence ("fmc" matches "frmmaincontrol")
+    let mut chars = query.chars();
+    let mut needle = chars.next()?;
+    for c in name.chars() {
+        if c == needle {
+            match chars.next() {
+                Some(next) => needle = next,
+                None => return Some(100),
+            }
+        }
+    }
+    None
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::analysis::build_symbol_table;
+    use crate::parser::Vb6Parser;
+    use ropey::Rope;
+    use tower_lsp::lsp_types::Url;
+
+    fn build_table(path: &str, source: &str) -> SymbolTable {
+        let mut parser = Vb6Parser::new();
+        let tree = parser.parse_rope(&Rope::from_str(source)).unwrap();
+        let uri = Url::from_file_path(path).unwrap();
+        build_symbol_table(uri, source, &tree)
+    }
+
+    #[test]
+    fn test_index_lookup_and_prefix() {
+        let source = "Public Sub DoWork()\nEnd Sub\n\nPublic gCounter As Long\n";
+        let table = build_table("/tmp/ModMain.bas", source);
+
+        let mut index = SymbolIndex::new();
+        index.add_file(Path::new("/tmp/ModMain.bas"), &table);
+
+        assert_eq!(index.lookup("dowork").len(), 1);
+        assert_eq!(index.lookup("DOWORK").len(), 1);
+        assert_eq!(index.lookup("missing").len(), 0);
+
+        let hits: Vec<_> = index.prefix("do").collect();
+        assert_eq!(hits.len(), 1);
+        assert_eq!(&*hits[0].name, "DoWork");
+    }
+
+    #[test]
+    fn test_query_ranking() {
+        let source = "Public Sub DoWork()\nEnd Sub\n\nPublic Sub DoWorkItem()\nEnd Sub\n\nPublic Sub RedoWork()\nEnd Sub\n";
+        let table = build_table("/tmp/ModMain.bas", source);
+
+        let mut index = SymbolIndex::new();
+        index.add_file(Path::new("/tmp/ModMain.bas"), &table);
+
+        // Exact match outranks prefix, which outranks substring
+        let hits: Vec<_> = index.query("dowork", 10);
+        let names: Vec<&str> = hits.iter().map(|p| &*p.name).collect();
+        assert_eq!(names, vec!["DoWork", "DoWorkItem", "RedoWork"]);
+
+        // Subsequence match ("dwi" -> DoWorkItem)
+        let hits = index.query("dwi", 10);
+        assert_eq!(&*hits[0].name, "DoWorkItem");
+
+        // Limit is respected
+        assert_eq!(index.query("dowork", 2).len(), 2);
+    }
+
+    #[test]
+    fn test_index_remove_file() {
+        let table = build_table("/tmp/ModMain.bas", "Public gValue As Long\n");
+
+        let mut index = SymbolIndex::new();
+        index.add_file(Path::new("/tmp/ModMain.bas"), &table);
+        assert_eq!(index.lookup("gvalue").len(), 1);
+
+        index.remove_file(Path::new("/tmp/ModMain.bas"));
+        assert_eq!(index.lookup("gvalue").len(), 0);
+        assert_eq!(index.name_count(), 0);
+        assert_eq!(index.file_count(), 0);
+    }
+
+    #[test]
+    fn test_add_file_replaces_previous_entries() {
+        let path = Path::new("/tmp/ModMain.bas");
+        let mut index = SymbolIndex::new();
+
+        index.add_file(path, &build_table("/tmp/ModMain.bas", "Public gOld As Long\n"));
+        index.add_file(path, &build_table("/tmp/ModMain.bas", "Public gNew As Long\n"));
+
+        assert_eq!(index.lookup("gold").len(), 0);
+        assert_eq!(index.lookup("gnew").len(), 1);
+    }
+}
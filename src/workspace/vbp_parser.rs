@@ -75,8 +75,11 @@ pub struct VbpFile {
     /// Compatibility settings
     pub compatibility: CompatibilitySettings,
 
-    /// Custom property sections (e.g., [MS Transaction Server])
-    pub custom_sections: HashMap<String, HashMap<String, String>>,
+    /// Custom property sections (e.g., [MS Transaction Server]),
+    /// kept as raw body text and parsed on demand by
+    /// `get_custom_section` — most projects carry sections nobody ever
+    /// consults, so they shouldn't pay per-key allocations up front
+    pub custom_sections: HashMap<String, String>,
 
     /// All raw key-value pairs (for properties we don't specifically handle)
     pub properties: HashMap<String, String>,
@@ -411,24 +414,26 @@ impl VbpFile {
                 let section_name = line[1..line.len() - 1].to_string();
                 vbp.custom_sections
                     .entry(section_name.clone())
-                    .or_insert_with(HashMap::new);
+                    .or_default();
                 current_section = Some(section_name);
                 continue;
             }
 
+            // Custom section bodies are kept raw (one append per line,
+            // no per-key/per-value Strings); parsed lazily if consulted
+            if let Some(ref section) = current_section {
+                if let Some(body) = vbp.custom_sections.get_mut(section) {
+                    body.push_str(line);
+                    body.push('\n');
+                }
+                continue;
+            }
+
             // Parse key=value
             if let Some((key, value)) = line.split_once('=') {
                 let key = key.trim();
                 let value = value.trim();
 
-                // If we're in a custom section, store there
-                if let Some(ref section) = current_section {
-                    if let Some(section_map) = vbp.custom_sections.get_mut(section) {
-                        section_map.insert(key.to_string(), value.to_string());
-                    }
-                    continue;
-                }
-
                 // Parse standard VBP properties
                 match key {
                     "Type" => {
@@ -689,9 +694,15 @@ impl VbpFile {
             .collect()
     }
 
-    /// Get a custom section's properties
-    pub fn get_custom_section(&self, name: &str) -> Option<&HashMap<String, String>> {
-        self.custom_sections.get(name)
+    /// Get a custom section's properties, parsed from the raw body on
+    /// demand (keys and values borrow from the stored text)
+    pub fn get_custom_section(&self, name: &str) -> Option<HashMap<&str, &str>> {
+        self.custom_sections.get(name).map(|body| {
+            body.lines()
+                .filter_map(|line| line.split_once('='))
+                .map(|(key, value)| (key.trim(), value.trim()))
+                .collect()
+        })
     }
 }
 
@@ -1049,7 +1060,7 @@ AutoRefresh=1
         let mts_section = vbp.get_custom_section("MS Transaction Server");
         assert!(mts_section.is_some());
         let mts = mts_section.unwrap();
-        assert_eq!(mts.get("AutoRefresh"), Some(&"1".to_string()));
+        assert_eq!(mts.get("AutoRefresh"), Some(&"1"));
     }
 
     #[test]
@@ -23,42 +23,63 @@ enum TokenType {
     LABEL_IDENTIFIER,
 };
 
-// Reserved keywords that cannot be used as callable names (case-insensitive)
-// These are keywords that would conflict with call statements
-static const char *RESERVED_KEYWORDS[] = {
-    "public", "private", "friend", "global",  // Visibility modifiers
-    "dim", "static", "const", "withevents",   // Declaration keywords
-    "type", "enum", "class",                  // Type definition keywords
-    "sub", "function", "property", "event",   // Procedure keywords
-    "declare", "implements",                  // Other declaration keywords
-    "if", "then", "else", "elseif", "end",   // Control flow
-    "for", "to", "step", "next", "each", "in", // For loops
-    "do", "loop", "while", "until", "wend",   // While/Do loops
-    "select", "case",                          // Select case
-    "with", "new",                             // With/New
-    "exit", "return", "goto", "gosub", "on",  // Jump statements
-    "set", "let",                              // Assignment keywords
-    "call",                                    // Call keyword
-    "redim", "preserve", "erase",             // Array keywords
-    "option", "attribute",                    // Module keywords
-    "true", "false", "nothing", "null", "empty", // Literals
-    "and", "or", "not", "xor", "eqv", "imp", "is", "like", "mod", // Operators
-    "as", "byval", "byref", "optional", "paramarray", // Parameter keywords
-    "resume", "error",                         // Error handling
-    "raiseevent",                              // Event raising
-    "version", "begin",                        // Module header/config
-    "open", "close", "input", "line", "print", "write", // File I/O
-    "get", "put", "seek", "lock", "unlock", "width",    // File I/O
-    "appactivate", "beep", "chdir", "chdrive",          // System statements
-    "mkdir", "rmdir", "kill", "name", "filecopy",
-    "load", "unload", "date", "time", "randomize",
-    "lset", "rset", "mid", "stop", "sendkeys",
-    "savepicture", "savesetting", "deletesetting",
-    "setattr", "reset",
-    "rem",                                      // Comment keyword
-    NULL  // Sentinel
+// Reserved keywords that cannot be used as callable names (case-insensitive).
+// These are keywords that would conflict with call statements. Bucketed by
+// length so a lookup only compares candidates of the word's own length.
+static const char *RESERVED_2[] = {
+    "as", "do", "if", "in", "is", "on", "or", "to", NULL
+};
+static const char *RESERVED_3[] = {
+    "and", "dim", "end", "eqv", "for", "get", "imp", "let", "mid",
+    "mod", "new", "not", "put", "rem", "set", "sub", "xor", NULL
+};
+static const char *RESERVED_4[] = {
+    "beep", "call", "case", "date", "each", "else", "enum", "exit",
+    "goto", "kill", "like", "line", "load", "lock", "loop", "lset",
+    "name", "next", "null", "open", "rset", "seek", "step", "stop",
+    "then", "time", "true", "type", "wend", "with", NULL
+};
+static const char *RESERVED_5[] = {
+    "begin", "byref", "byval", "chdir", "class", "close", "const",
+    "empty", "erase", "error", "event", "false", "gosub", "input",
+    "mkdir", "print", "redim", "reset", "rmdir", "until", "while",
+    "width", "write", NULL
+};
+static const char *RESERVED_6[] = {
+    "elseif", "friend", "global", "option", "public", "resume",
+    "return", "select", "static", "unload", "unlock", NULL
+};
+static const char *RESERVED_7[] = {
+    "chdrive", "declare", "nothing", "private", "setattr", "version",
+    NULL
+};
+static const char *RESERVED_8[] = {
+    "filecopy", "function", "optional", "preserve", "property",
+    "sendkeys", NULL
+};
+static const char *RESERVED_9[] = {
+    "attribute", "randomize", NULL
+};
+static const char *RESERVED_10[] = {
+    "implements", "paramarray", "raiseevent", "withevents", NULL
+};
+static const char *RESERVED_11[] = {
+    "appactivate", "savepicture", "savesetting", NULL
+};
+static const char *RESERVED_13[] = {
+    "deletesetting", NULL
 };
 
+// Buckets indexed by keyword length; empty lengths share one sentinel
+static const char *RESERVED_NONE[] = { NULL };
+static const char **RESERVED_BY_LEN[] = {
+    RESERVED_NONE, RESERVED_NONE, RESERVED_2, RESERVED_3, RESERVED_4,
+    RESERVED_5, RESERVED_6, RESERVED_7, RESERVED_8, RESERVED_9,
+    RESERVED_10, RESERVED_11, RESERVED_NONE, RESERVED_13,
+};
+
+#define RESERVED_MAX_LEN 13
+
 // Forward declarations
 static bool scan_line_continuation(TSLexer *lexer);
 static bool scan_date_literal(TSLexer *lexer);
@@ -205,16 +226,18 @@ static int to_lower(int c) {
 }
 
 /**
- * Check if word is a reserved keyword (case-insensitive)
+ * Check if word is a reserved keyword (case-insensitive).
+ * Only the length bucket for the word is scanned, and candidates within
+ * it all have the word's exact length, so no strlen calls are needed.
  */
 static bool is_reserved_keyword(const char *word, size_t len) {
-    for (int i = 0; RESERVED_KEYWORDS[i] != NULL; i++) {
-        const char *keyword = RESERVED_KEYWORDS[i];
-        size_t kw_len = strlen(keyword);
+    if (len < 2 || len > RESERVED_MAX_LEN) {
+        return false;
+    }
 
-        if (len != kw_len) {
-            continue;
-        }
+    const char **bucket = RESERVED_BY_LEN[len];
+    for (int i = 0; bucket[i] != NULL; i++) {
+        const char *keyword = bucket[i];
 
         bool match = true;
         for (size_t j = 0; j < len; j++) {